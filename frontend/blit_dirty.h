@@ -0,0 +1,133 @@
+/*
+ * (C) notaz, 2011
+ *
+ * This work is licensed under the terms of the GNU GPLv2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+/*
+ * per-scanline VRAM dirty tracking for GPU plugin blitters.
+ *
+ * Each VRAM line remembers the blit generation it was last written in.
+ * Since the frontend flips between several framebuffers, we also remember
+ * which generation (and display layout) each of them last received,
+ * so only lines modified since then need to be converted again.
+ * Drawing primitives only report their drawing area, which keeps
+ * the per-primitive cost at a couple of compares.
+ */
+
+#ifndef __BLIT_DIRTY_H__
+#define __BLIT_DIRTY_H__
+
+#include <string.h>
+
+#define BLIT_DIRTY_LINES 512
+#define BLIT_DIRTY_BUFS  4
+
+struct blit_dirty_layout {
+	int x, y, w, h, bpp, ofs;
+};
+
+struct blit_dirty {
+	unsigned int gen;
+	unsigned int line_gen[BLIT_DIRTY_LINES];
+	int draw_y0, draw_y1;		// pending drawing area, inclusive
+	int draw_pending;
+	int buf_next;
+	struct {
+		const void *ptr;
+		unsigned int gen;
+		struct blit_dirty_layout layout;
+	} buf[BLIT_DIRTY_BUFS];
+};
+
+/* forget framebuffer contents, next blits will be full */
+static inline void blit_dirty_invalidate(struct blit_dirty *d)
+{
+	memset(d->buf, 0, sizeof(d->buf));
+	d->buf_next = 0;
+	if (d->gen == 0)
+		d->gen = 1;
+}
+
+static inline void blit_dirty_mark(struct blit_dirty *d, int y, int h)
+{
+	if (h >= BLIT_DIRTY_LINES)
+		h = BLIT_DIRTY_LINES;
+	for (; h > 0; h--, y++)
+		d->line_gen[y & (BLIT_DIRTY_LINES - 1)] = d->gen;
+}
+
+static inline void blit_dirty_mark_all(struct blit_dirty *d)
+{
+	blit_dirty_mark(d, 0, BLIT_DIRTY_LINES);
+}
+
+static inline void blit_dirty_flush(struct blit_dirty *d)
+{
+	if (d->draw_pending) {
+		blit_dirty_mark(d, d->draw_y0, d->draw_y1 - d->draw_y0 + 1);
+		d->draw_pending = 0;
+	}
+}
+
+/* called for every drawing primitive, y0/y1 is the clip area */
+static inline void blit_dirty_draw(struct blit_dirty *d, int y0, int y1)
+{
+	if (d->draw_pending) {
+		if (y0 == d->draw_y0 && y1 == d->draw_y1)
+			return;
+		blit_dirty_flush(d);
+	}
+	if (y1 < y0)
+		return;
+	d->draw_y0 = y0;
+	d->draw_y1 = y1;
+	d->draw_pending = 1;
+}
+
+/* returns generation the framebuffer was last blitted at, 0 if unknown */
+static inline unsigned int blit_dirty_begin(struct blit_dirty *d,
+	const void *fb, const struct blit_dirty_layout *layout)
+{
+	int i;
+
+	blit_dirty_flush(d);
+
+	for (i = 0; i < BLIT_DIRTY_BUFS; i++) {
+		if (d->buf[i].ptr != fb)
+			continue;
+		if (memcmp(&d->buf[i].layout, layout, sizeof(*layout)) != 0)
+			return 0;
+		return d->buf[i].gen;
+	}
+
+	return 0;
+}
+
+static inline int blit_dirty_line(const struct blit_dirty *d,
+	unsigned int since, int y)
+{
+	return since == 0 || d->line_gen[y & (BLIT_DIRTY_LINES - 1)] > since;
+}
+
+static inline void blit_dirty_end(struct blit_dirty *d,
+	const void *fb, const struct blit_dirty_layout *layout)
+{
+	int i;
+
+	for (i = 0; i < BLIT_DIRTY_BUFS; i++)
+		if (d->buf[i].ptr == fb)
+			break;
+	if (i == BLIT_DIRTY_BUFS) {
+		i = d->buf_next;
+		d->buf_next = (d->buf_next + 1) % BLIT_DIRTY_BUFS;
+	}
+
+	d->buf[i].ptr = fb;
+	d->buf[i].gen = d->gen;
+	d->buf[i].layout = *layout;
+	d->gen++;
+}
+
+#endif /* __BLIT_DIRTY_H__ */
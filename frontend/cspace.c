@@ -0,0 +1,341 @@
+/*
+ * (C) notaz, 2011
+ *
+ * This work is licensed under the terms of the GNU GPLv2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+/*
+ * color space conversions used by blitters.
+ * ARM builds get 555/888 converters from arm_utils.s, here we have
+ * C versions of everything plus SSE2/SSSE3/AVX2 ones for x86,
+ * selected at runtime on first call.
+ * len is in bytes of source data, like in the asm versions.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arm_utils.h"
+
+#if defined(__i386__) || defined(__x86_64__)
+#define HAVE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+/* PSX mask bit ends up in green lsb, same as arm_utils.s does */
+#define CONV_555_565(p) \
+	((((p) << 11) & 0xf800) | (((p) << 1) & 0x07c0) | (((p) >> 10) & 0x003f))
+
+static inline uint32_t conv_555_8888(uint32_t p)
+{
+	uint32_t r = (p << 3) & 0xf8, g = (p >> 2) & 0xf8, b = (p >> 7) & 0xf8;
+	r |= r >> 5; g |= g >> 5; b |= b >> 5;
+	return (r << 16) | (g << 8) | b;
+}
+
+static void bgr555_to_rgb565_c(void *dst, void *src, int bytes)
+{
+	const uint16_t *s = src;
+	uint16_t *d = dst;
+	int i;
+
+	for (i = 0; i < bytes / 2; i++)
+		d[i] = CONV_555_565(s[i]);
+}
+
+static void bgr888_to_rgb888_c(void *dst, void *src, int bytes)
+{
+	const uint8_t *s = src;
+	uint8_t *d = dst;
+	uint8_t t;
+	int i;
+
+	for (i = 0; i + 2 < bytes; i += 3) {
+		t = s[i]; // might be in-place
+		d[i + 1] = s[i + 1];
+		d[i] = s[i + 2];
+		d[i + 2] = t;
+	}
+}
+
+static void bgr888_to_rgb565_c(void *dst, void *src, int bytes)
+{
+	const uint8_t *s = src;
+	uint16_t *d = dst;
+	int i;
+
+	for (i = 0; i + 2 < bytes; i += 3, d++)
+		*d = ((s[i] & 0xf8) << 8) | ((s[i + 1] & 0xfc) << 3) | (s[i + 2] >> 3);
+}
+
+static void bgr555_to_rgb8888_c(void *dst, void *src, int bytes)
+{
+	const uint16_t *s = src;
+	uint32_t *d = dst;
+	int i;
+
+	for (i = 0; i < bytes / 2; i++)
+		d[i] = conv_555_8888(s[i]);
+}
+
+static void bgr888_to_rgb8888_c(void *dst, void *src, int bytes)
+{
+	const uint8_t *s = src;
+	uint32_t *d = dst;
+	int i;
+
+	for (i = 0; i + 2 < bytes; i += 3, d++)
+		*d = (s[i] << 16) | (s[i + 1] << 8) | s[i + 2];
+}
+
+#ifdef HAVE_X86_SIMD
+
+/* 555 -> 565, 8 pixels */
+#define SSE_555_565(p) \
+	_mm_or_si128(_mm_or_si128(_mm_slli_epi16(p, 11), \
+		_mm_and_si128(_mm_slli_epi16(p, 1), m_g)), \
+		_mm_and_si128(_mm_srli_epi16(p, 10), m_b))
+
+__attribute__((target("sse2")))
+static void bgr555_to_rgb565_sse2(void *dst, void *src, int bytes)
+{
+	const __m128i m_g = _mm_set1_epi16(0x07c0);
+	const __m128i m_b = _mm_set1_epi16(0x003f);
+	const uint8_t *s = src;
+	uint8_t *d = dst;
+	__m128i p0, p1;
+
+	for (; bytes >= 32; bytes -= 32, s += 32, d += 32) {
+		p0 = _mm_loadu_si128((const __m128i *)s);
+		p1 = _mm_loadu_si128((const __m128i *)(s + 16));
+		_mm_storeu_si128((__m128i *)d, SSE_555_565(p0));
+		_mm_storeu_si128((__m128i *)(d + 16), SSE_555_565(p1));
+	}
+	if (bytes > 0)
+		bgr555_to_rgb565_c(d, (void *)s, bytes);
+}
+
+#define AVX_555_565(p) \
+	_mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(p, 11), \
+		_mm256_and_si256(_mm256_slli_epi16(p, 1), m_g)), \
+		_mm256_and_si256(_mm256_srli_epi16(p, 10), m_b))
+
+__attribute__((target("avx2")))
+static void bgr555_to_rgb565_avx2(void *dst, void *src, int bytes)
+{
+	const __m256i m_g = _mm256_set1_epi16(0x07c0);
+	const __m256i m_b = _mm256_set1_epi16(0x003f);
+	const uint8_t *s = src;
+	uint8_t *d = dst;
+	__m256i p0, p1;
+
+	for (; bytes >= 64; bytes -= 64, s += 64, d += 64) {
+		p0 = _mm256_loadu_si256((const __m256i *)s);
+		p1 = _mm256_loadu_si256((const __m256i *)(s + 32));
+		_mm256_storeu_si256((__m256i *)d, AVX_555_565(p0));
+		_mm256_storeu_si256((__m256i *)(d + 32), AVX_555_565(p1));
+	}
+	if (bytes > 0)
+		bgr555_to_rgb565_sse2(d, (void *)s, bytes);
+}
+
+/* 555 -> 8888, 8 pixels in, 2 vectors out */
+__attribute__((target("sse2")))
+static void bgr555_to_rgb8888_sse2(void *dst, void *src, int bytes)
+{
+	const __m128i m_5 = _mm_set1_epi16(0x00f8);
+	const uint8_t *s = src;
+	uint8_t *d = dst;
+	__m128i p, r, g, b;
+
+	for (; bytes >= 16; bytes -= 16, s += 16, d += 32) {
+		p = _mm_loadu_si128((const __m128i *)s);
+		r = _mm_and_si128(_mm_slli_epi16(p, 3), m_5);
+		g = _mm_and_si128(_mm_srli_epi16(p, 2), m_5);
+		b = _mm_and_si128(_mm_srli_epi16(p, 7), m_5);
+		r = _mm_or_si128(r, _mm_srli_epi16(r, 5));
+		g = _mm_or_si128(g, _mm_srli_epi16(g, 5));
+		b = _mm_or_si128(b, _mm_srli_epi16(b, 5));
+		g = _mm_or_si128(_mm_slli_epi16(g, 8), b);
+		_mm_storeu_si128((__m128i *)d, _mm_unpacklo_epi16(g, r));
+		_mm_storeu_si128((__m128i *)(d + 16), _mm_unpackhi_epi16(g, r));
+	}
+	if (bytes > 0)
+		bgr555_to_rgb8888_c(d, (void *)s, bytes);
+}
+
+__attribute__((target("avx2")))
+static void bgr555_to_rgb8888_avx2(void *dst, void *src, int bytes)
+{
+	const __m256i m_5 = _mm256_set1_epi16(0x00f8);
+	const uint8_t *s = src;
+	uint8_t *d = dst;
+	__m256i p, r, g, b, lo, hi;
+
+	for (; bytes >= 32; bytes -= 32, s += 32, d += 64) {
+		p = _mm256_loadu_si256((const __m256i *)s);
+		r = _mm256_and_si256(_mm256_slli_epi16(p, 3), m_5);
+		g = _mm256_and_si256(_mm256_srli_epi16(p, 2), m_5);
+		b = _mm256_and_si256(_mm256_srli_epi16(p, 7), m_5);
+		r = _mm256_or_si256(r, _mm256_srli_epi16(r, 5));
+		g = _mm256_or_si256(g, _mm256_srli_epi16(g, 5));
+		b = _mm256_or_si256(b, _mm256_srli_epi16(b, 5));
+		g = _mm256_or_si256(_mm256_slli_epi16(g, 8), b);
+		// unpack works per 128bit lane, fix up the order on store
+		lo = _mm256_unpacklo_epi16(g, r);
+		hi = _mm256_unpackhi_epi16(g, r);
+		_mm256_storeu_si256((__m256i *)d, _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256((__m256i *)(d + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+	if (bytes > 0)
+		bgr555_to_rgb8888_sse2(d, (void *)s, bytes);
+}
+
+/*
+ * 888 ones need byte shuffles, so SSSE3 is the baseline.
+ * 4 pixels (12 bytes) per 16 byte op, C handles the tail.
+ * The 4 extra stored bytes are the unconverted source bytes, so
+ * 888->888 stays safe in-place, the next iteration converts them.
+ */
+#define SHUF_888_888 \
+	2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 12, 13, 14, 15
+#define SHUF_888_8888 \
+	2, 1, 0, 0x80, 5, 4, 3, 0x80, 8, 7, 6, 0x80, 11, 10, 9, 0x80
+
+__attribute__((target("ssse3")))
+static void bgr888_to_rgb888_ssse3(void *dst, void *src, int bytes)
+{
+	const __m128i shuf = _mm_setr_epi8(SHUF_888_888);
+	const uint8_t *s = src;
+	uint8_t *d = dst;
+	__m128i p;
+
+	for (; bytes >= 16; bytes -= 12, s += 12, d += 12) {
+		p = _mm_loadu_si128((const __m128i *)s);
+		_mm_storeu_si128((__m128i *)d, _mm_shuffle_epi8(p, shuf));
+	}
+	if (bytes > 0)
+		bgr888_to_rgb888_c(d, (void *)s, bytes);
+}
+
+__attribute__((target("avx2")))
+static void bgr888_to_rgb888_avx2(void *dst, void *src, int bytes)
+{
+	const __m256i shuf = _mm256_setr_epi8(SHUF_888_888, SHUF_888_888);
+	const uint8_t *s = src;
+	uint8_t *d = dst;
+	__m256i p;
+
+	for (; bytes >= 28; bytes -= 24, s += 24, d += 24) {
+		p = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)s));
+		p = _mm256_inserti128_si256(p, _mm_loadu_si128((const __m128i *)(s + 12)), 1);
+		p = _mm256_shuffle_epi8(p, shuf);
+		_mm_storeu_si128((__m128i *)d, _mm256_castsi256_si128(p));
+		_mm_storeu_si128((__m128i *)(d + 12), _mm256_extracti128_si256(p, 1));
+	}
+	if (bytes > 0)
+		bgr888_to_rgb888_ssse3(d, (void *)s, bytes);
+}
+
+__attribute__((target("ssse3")))
+static void bgr888_to_rgb8888_ssse3(void *dst, void *src, int bytes)
+{
+	const __m128i shuf = _mm_setr_epi8(SHUF_888_8888);
+	const uint8_t *s = src;
+	uint8_t *d = dst;
+	__m128i p;
+
+	for (; bytes >= 16; bytes -= 12, s += 12, d += 16) {
+		p = _mm_loadu_si128((const __m128i *)s);
+		_mm_storeu_si128((__m128i *)d, _mm_shuffle_epi8(p, shuf));
+	}
+	if (bytes > 0)
+		bgr888_to_rgb8888_c(d, (void *)s, bytes);
+}
+
+__attribute__((target("avx2")))
+static void bgr888_to_rgb8888_avx2(void *dst, void *src, int bytes)
+{
+	const __m256i shuf = _mm256_setr_epi8(SHUF_888_8888, SHUF_888_8888);
+	const uint8_t *s = src;
+	uint8_t *d = dst;
+	__m256i p;
+
+	for (; bytes >= 28; bytes -= 24, s += 24, d += 32) {
+		p = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)s));
+		p = _mm256_inserti128_si256(p, _mm_loadu_si128((const __m128i *)(s + 12)), 1);
+		_mm256_storeu_si256((__m256i *)d, _mm256_shuffle_epi8(p, shuf));
+	}
+	if (bytes > 0)
+		bgr888_to_rgb8888_ssse3(d, (void *)s, bytes);
+}
+
+#endif // HAVE_X86_SIMD
+
+typedef void (cspace_func)(void *dst, void *src, int bytes);
+
+static cspace_func *f_555_565, *f_888_888, *f_888_565;
+static cspace_func *f_555_8888, *f_888_8888;
+
+static void cspace_select(void)
+{
+	f_555_565 = bgr555_to_rgb565_c;
+	f_888_888 = bgr888_to_rgb888_c;
+	f_888_565 = bgr888_to_rgb565_c;
+	f_555_8888 = bgr555_to_rgb8888_c;
+	f_888_8888 = bgr888_to_rgb8888_c;
+
+#ifdef HAVE_X86_SIMD
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2")) {
+		f_555_565 = bgr555_to_rgb565_sse2;
+		f_555_8888 = bgr555_to_rgb8888_sse2;
+	}
+	if (__builtin_cpu_supports("ssse3")) {
+		f_888_888 = bgr888_to_rgb888_ssse3;
+		f_888_8888 = bgr888_to_rgb8888_ssse3;
+	}
+	if (__builtin_cpu_supports("avx2")) {
+		f_555_565 = bgr555_to_rgb565_avx2;
+		f_555_8888 = bgr555_to_rgb8888_avx2;
+		f_888_888 = bgr888_to_rgb888_avx2;
+		f_888_8888 = bgr888_to_rgb8888_avx2;
+	}
+#endif
+}
+
+#define CSPACE_CALL(f, d, s, len) { \
+	if (f == NULL) \
+		cspace_select(); \
+	f(d, s, len); \
+}
+
+#ifndef __arm__
+
+void bgr555_to_rgb565(void *dst, void *src, int bytes)
+{
+	CSPACE_CALL(f_555_565, dst, src, bytes);
+}
+
+void bgr888_to_rgb888(void *dst, void *src, int bytes)
+{
+	CSPACE_CALL(f_888_888, dst, src, bytes);
+}
+
+void bgr888_to_rgb565(void *dst, void *src, int bytes)
+{
+	CSPACE_CALL(f_888_565, dst, src, bytes);
+}
+
+#endif
+
+void bgr555_to_rgb8888(void *dst, void *src, int bytes)
+{
+	CSPACE_CALL(f_555_8888, dst, src, bytes);
+}
+
+void bgr888_to_rgb8888(void *dst, void *src, int bytes)
+{
+	CSPACE_CALL(f_888_8888, dst, src, bytes);
+}
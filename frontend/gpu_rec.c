@@ -0,0 +1,231 @@
+/*
+ * (C) notaz, 2011
+ *
+ * This work is licensed under the terms of the GNU GPLv2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <zlib.h>
+
+#include "gpu_rec.h"
+#include "../libpcsxcore/plugins.h"
+
+// worst case chain is all of RAM with some revisits
+#define CHAIN_BUF_WORDS (0x200000 / 4 * 2)
+
+static gzFile rec_file;
+static int rec_need_state;
+static GPUFreeze_t *rec_freeze;
+static uint32_t *chain_buf;
+
+static GPUwriteStatus  o_GPU_writeStatus;
+static GPUwriteData    o_GPU_writeData;
+static GPUwriteDataMem o_GPU_writeDataMem;
+static GPUreadData     o_GPU_readData;
+static GPUreadDataMem  o_GPU_readDataMem;
+static GPUdmaChain     o_GPU_dmaChain;
+static GPUupdateLace   o_GPU_updateLace;
+static GPUfreeze       o_GPU_freeze;
+static GPUvBlank       o_GPU_vBlank;
+
+static void rec_write(enum grec_type type, const uint32_t *data, int len)
+{
+	uint32_t hdr = GREC_HDR(type, len);
+
+	gzwrite(rec_file, &hdr, sizeof(hdr));
+	if (len > 0)
+		gzwrite(rec_file, data, len * 4);
+}
+
+static void rec_write_state(GPUFreeze_t *f)
+{
+	rec_write(GREC_STATE, (uint32_t *)f, sizeof(*f) / 4);
+}
+
+/* can't do this at hook time, plugin may not be initialized yet */
+static void rec_check_state(void)
+{
+	if (!rec_need_state)
+		return;
+
+	rec_freeze->ulFreezeVersion = 1;
+	if (o_GPU_freeze(1, rec_freeze) == 1)
+		rec_write_state(rec_freeze);
+	else
+		fprintf(stderr, "gpu_rec: could not get GPU state\n");
+	rec_need_state = 0;
+}
+
+static void CALLBACK w_GPU_writeStatus(uint32_t data)
+{
+	rec_check_state();
+	rec_write(GREC_STATUS, &data, 1);
+	o_GPU_writeStatus(data);
+}
+
+static void CALLBACK w_GPU_writeData(uint32_t data)
+{
+	rec_check_state();
+	rec_write(GREC_DATA, &data, 1);
+	o_GPU_writeData(data);
+}
+
+static void CALLBACK w_GPU_writeDataMem(uint32_t *mem, int count)
+{
+	rec_check_state();
+	rec_write(GREC_DATA, mem, count);
+	o_GPU_writeDataMem(mem, count);
+}
+
+static uint32_t CALLBACK w_GPU_readData(void)
+{
+	uint32_t count = 1;
+
+	rec_check_state();
+	rec_write(GREC_READ, &count, 1);
+	return o_GPU_readData();
+}
+
+static void CALLBACK w_GPU_readDataMem(uint32_t *mem, int count)
+{
+	uint32_t c = count;
+
+	rec_check_state();
+	rec_write(GREC_READ, &c, 1);
+	o_GPU_readDataMem(mem, count);
+}
+
+/* walk the chain the same way plugins do and store what they'd see */
+static long CALLBACK w_GPU_dmaChain(uint32_t *base, uint32_t start)
+{
+	const unsigned char *base_b = (unsigned char *)base;
+	uint32_t addr = start;
+	uint32_t used[3] = { 0xffffff, 0xffffff, 0xffffff };
+	unsigned int loops = 0;
+	int len = 0, count;
+
+	rec_check_state();
+
+	do {
+		addr &= 0x1ffffc;
+		if (loops++ > 2000000)
+			break;
+		if (addr == used[1] || addr == used[2])
+			break;
+		if (addr < used[0]) used[1] = addr;
+		else                used[2] = addr;
+		used[0] = addr;
+
+		count = base_b[addr + 3];
+		if (len + 1 + count > CHAIN_BUF_WORDS) {
+			rec_write(GREC_DMACHAIN, chain_buf, len);
+			len = 0;
+		}
+		chain_buf[len++] = count;
+		memcpy(&chain_buf[len], &base[(addr + 4) >> 2], count * 4);
+		len += count;
+
+		addr = base[addr >> 2] & 0xffffff;
+	}
+	while (addr != 0xffffff);
+
+	if (len > 0)
+		rec_write(GREC_DMACHAIN, chain_buf, len);
+
+	return o_GPU_dmaChain(base, start);
+}
+
+static void CALLBACK w_GPU_updateLace(void)
+{
+	rec_check_state();
+	rec_write(GREC_VSYNC, NULL, 0);
+	o_GPU_updateLace();
+}
+
+static long CALLBACK w_GPU_freeze(uint32_t mode, GPUFreeze_t *f)
+{
+	// savestate load, replay needs it too
+	if (mode == 0 && f != NULL) {
+		rec_write_state(f);
+		rec_need_state = 0;
+	}
+	return o_GPU_freeze(mode, f);
+}
+
+static void CALLBACK w_GPU_vBlank(int val)
+{
+	uint32_t v = val;
+
+	rec_check_state();
+	rec_write(GREC_VBLANK, &v, 1);
+	o_GPU_vBlank(v);
+}
+
+#define hook_it(name) { \
+	o_##name = name; \
+	name = w_##name; \
+}
+
+/* called after every LoadPlugins() */
+void gpu_rec_hook_plugins(void)
+{
+	if (rec_file == NULL)
+		return;
+
+	hook_it(GPU_writeStatus);
+	hook_it(GPU_writeData);
+	hook_it(GPU_writeDataMem);
+	hook_it(GPU_readData);
+	hook_it(GPU_readDataMem);
+	hook_it(GPU_dmaChain);
+	hook_it(GPU_updateLace);
+	hook_it(GPU_freeze);
+	if (GPU_vBlank != NULL)
+		hook_it(GPU_vBlank);
+
+	// new plugin, state may have changed
+	rec_need_state = 1;
+}
+
+int gpu_rec_start(const char *fname)
+{
+	uint32_t ver = GREC_VERSION;
+
+	rec_freeze = malloc(sizeof(*rec_freeze));
+	chain_buf = malloc(CHAIN_BUF_WORDS * 4);
+	if (rec_freeze == NULL || chain_buf == NULL) {
+		fprintf(stderr, "gpu_rec: OOM\n");
+		goto fail;
+	}
+
+	rec_file = gzopen(fname, "wb1");
+	if (rec_file == NULL) {
+		fprintf(stderr, "gpu_rec: can't open %s\n", fname);
+		goto fail;
+	}
+
+	gzwrite(rec_file, GREC_MAGIC, 8);
+	gzwrite(rec_file, &ver, sizeof(ver));
+	printf("recording GPU commands to %s\n", fname);
+	return 0;
+
+fail:
+	free(rec_freeze);
+	free(chain_buf);
+	rec_freeze = NULL;
+	chain_buf = NULL;
+	return -1;
+}
+
+void gpu_rec_stop(void)
+{
+	if (rec_file == NULL)
+		return;
+
+	gzclose(rec_file);
+	rec_file = NULL;
+}
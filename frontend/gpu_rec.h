@@ -0,0 +1,42 @@
+/*
+ * (C) notaz, 2011
+ *
+ * This work is licensed under the terms of the GNU GPLv2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+/*
+ * GPU command stream recording, for replaying through GPU plugins
+ * offline (see tools/gpu_replay.c).
+ *
+ * File is gzipped, starts with GREC_MAGIC and a version word,
+ * then a sequence of records: a header word ((type << 24) | len)
+ * followed by len little endian payload words.
+ */
+
+#ifndef __GPU_REC_H__
+#define __GPU_REC_H__
+
+#define GREC_MAGIC   "PSXGREC"
+#define GREC_VERSION 1
+
+enum grec_type {
+	GREC_STATE = 1,		// GPUFreeze_t, sent to GPUfreeze(0, ..)
+	GREC_DATA,		// GPUwriteDataMem() words
+	GREC_STATUS,		// GPUwriteStatus() word
+	GREC_DMACHAIN,		// flattened chain: (count, count words)...
+	GREC_READ,		// GPUreadDataMem() word count
+	GREC_VSYNC,		// GPUupdateLace(), no payload
+	GREC_VBLANK,		// GPUvBlank() arg
+};
+
+#define GREC_HDR(type, len)  (((type) << 24) | (len))
+#define GREC_HDR_TYPE(hdr)   ((hdr) >> 24)
+#define GREC_HDR_LEN(hdr)    ((hdr) & 0xffffff)
+#define GREC_MAX_LEN         0xffffff
+
+int  gpu_rec_start(const char *fname);
+void gpu_rec_stop(void);
+void gpu_rec_hook_plugins(void);
+
+#endif /* __GPU_REC_H__ */
@@ -19,8 +19,10 @@
 #include "plugin.h"
 #include "plugin_lib.h"
 #include "pcnt.h"
+#include "gpu_rec.h"
 #include "menu.h"
 #include "../libpcsxcore/misc.h"
+#include "../libpcsxcore/psxlockstep.h"
 #include "../libpcsxcore/new_dynarec/new_dynarec.h"
 #include "../plugins/cdrcimg/cdrcimg.h"
 #include "common/plat.h"
@@ -67,6 +69,7 @@ static void CheckSubDir() {
 	create_profile_dir(PLUGINS_CFG_DIR);
 	create_profile_dir(CHEATS_DIR);
 	create_profile_dir(PATCHES_DIR);
+	create_profile_dir(DRC_CACHE_DIR);
 	create_profile_dir(PCSX_DOT_DIR "cfg");
 	create_profile_dir("/screenshots/");
 }
@@ -226,6 +229,7 @@ int main(int argc, char *argv[])
 	char path[MAXPATHLEN];
 	const char *cdfile = NULL;
 	int loadst = 0;
+	int lockstep = 0;
 	int i;
 
 	// read command line options
@@ -254,6 +258,15 @@ int main(int argc, char *argv[])
 
 			cdfile = isofilename;
 		}
+		else if (!strcmp(argv[i], "-gpurec")) {
+			if (i+1 >= argc) break;
+			if (gpu_rec_start(argv[++i]) != 0)
+				return 1;
+		}
+		else if (!strcmp(argv[i], "-lockstep")) {
+			if (i+1 >= argc) break;
+			lockstep = atoi(argv[++i]);
+		}
 		else if (!strcmp(argv[i], "-h") ||
 			 !strcmp(argv[i], "-help") ||
 			 !strcmp(argv[i], "--help")) {
@@ -266,6 +279,10 @@ int main(int argc, char *argv[])
 							"\t-cfg FILE\tLoads desired configuration file (default: ~/.pcsx/pcsx.cfg)\n"
 							"\t-psxout\t\tEnable PSX output\n"
 							"\t-load STATENUM\tLoads savestate STATENUM (1-5)\n"
+							"\t-gpurec FILE\tRecords GPU commands to FILE for tools/gpu_replay\n"
+							"\t-lockstep N\tRuns interpreter and recompiler side by side,\n"
+							"\t\t\tcomparing memory every N blocks; needs a file\n"
+							"\t\t\tand a USE_IX86_64 build\n"
 							"\t-h -help\tDisplay this message\n"
 							"\tfile\t\tLoads file\n"));
 			 return 0;
@@ -305,6 +322,7 @@ int main(int argc, char *argv[])
 		return 1;
 	}
 	pcnt_hook_plugins();
+	gpu_rec_hook_plugins();
 
 	if (OpenPlugins() == -1) {
 		return 1;
@@ -324,6 +342,7 @@ int main(int argc, char *argv[])
 				printf(_("Could not load CD-ROM!\n"));
 				return -1;
 			}
+			emu_drc_cache_load();
 			ready_to_go = 1;
 		}
 	}
@@ -340,6 +359,12 @@ int main(int argc, char *argv[])
 	else
 		menu_loop();
 
+	if (lockstep > 0 && ready_to_go) {
+		psxLockstepRun(&psxInt, &psxRec, lockstep);
+		printf("lockstep: could not start\n");
+		return 1;
+	}
+
 	pl_start_watchdog();
 
 	while (1)
@@ -401,6 +426,7 @@ void SysReset() {
 void SysClose() {
 	EmuShutdown();
 	ReleasePlugins();
+	gpu_rec_stop();
 
 	StopDebugger();
 
@@ -415,6 +441,7 @@ void OnFile_Exit() {
 #ifndef MAEMO
 	menu_finish();
 #endif
+	emu_drc_cache_save();
 	SysClose();
 	plat_finish();
 	exit(0);
@@ -461,6 +488,35 @@ int emu_load_state(int slot)
 	return LoadState(fname);
 }
 
+// translated code is kept per game, see new_dynarec_save_cache()
+static int get_drc_cache_filename(char *buf, int size) {
+	return get_gameid_filename(buf, size,
+		"." DRC_CACHE_DIR "%.32s-%.9s.drc", 0);
+}
+
+void emu_drc_cache_save(void)
+{
+	char fname[MAXPATHLEN];
+
+	if (Config.Cpu != CPU_DYNAREC || CdromId[0] == 0)
+		return;
+
+	get_drc_cache_filename(fname, sizeof(fname));
+	if (new_dynarec_save_cache(fname) != 0)
+		printf("could not save dynarec cache to %s\n", fname);
+}
+
+void emu_drc_cache_load(void)
+{
+	char fname[MAXPATHLEN];
+
+	if (Config.Cpu != CPU_DYNAREC || CdromId[0] == 0)
+		return;
+
+	get_drc_cache_filename(fname, sizeof(fname));
+	new_dynarec_load_cache(fname);
+}
+
 void SysPrintf(const char *fmt, ...) {
 	va_list list;
 	char msg[512];
@@ -30,6 +30,7 @@
 #define STATES_DIR "/.pcsx/sstates/"
 #define CHEATS_DIR "/.pcsx/cheats/"
 #define PATCHES_DIR "/.pcsx/patches/"
+#define DRC_CACHE_DIR "/.pcsx/drc/"
 #define BIOS_DIR "/bios/"
 
 extern char cfgfile_basename[MAXPATHLEN];
@@ -39,6 +40,8 @@ int get_state_filename(char *buf, int size, int i);
 int emu_check_state(int slot);
 int emu_save_state(int slot);
 int emu_load_state(int slot);
+void emu_drc_cache_save(void);
+void emu_drc_cache_load(void);
 
 void set_cd_image(const char *fname);
 
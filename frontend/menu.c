@@ -22,6 +22,7 @@
 #include "omap.h"
 #include "pandora.h"
 #include "pcnt.h"
+#include "gpu_rec.h"
 #include "arm_utils.h"
 #include "common/plat.h"
 #include "common/input.h"
@@ -168,6 +169,7 @@ static void menu_set_defconfig(void)
 	in_evdev_allow_abs_only = 0;
 	Config.Xa = Config.Cdda = Config.Sio =
 	Config.SpuIrq = Config.RCntFix = Config.VSyncWA = 0;
+	Config.CycleModel = 0;
 
 	iUseDither = 0;
 	UseFrameSkip = 1;
@@ -216,6 +218,7 @@ static const struct {
 	CE_CONFIG_VAL(SpuIrq),
 	CE_CONFIG_VAL(RCntFix),
 	CE_CONFIG_VAL(VSyncWA),
+	CE_CONFIG_VAL(CycleModel),
 	CE_CONFIG_VAL(Cpu),
 	CE_INTVAL(region),
 	CE_INTVAL(scaling),
@@ -1141,6 +1144,8 @@ static const char h_cfg_sio[]    = "This should be enabled for certain memcards/
 static const char h_cfg_spuirq[] = "Compatibility tweak; should probably be left off";
 static const char h_cfg_rcnt1[]  = "Parasite Eve 2, Vandal Hearts 1/2 Fix";
 static const char h_cfg_rcnt2[]  = "InuYasha Sengoku Battle Fix";
+static const char h_cfg_cycles[] = "Charge real mult/div/GTE timings, may help\n"
+				   "games that depend on them, or break others";
 static const char h_cfg_nodrc[]  = "Disable dynamic recompiler and use interpreter\n"
 				   "Might be useful to overcome some dynarec bugs";
 
@@ -1154,6 +1159,7 @@ static menu_entry e_menu_adv_options[] =
 	mee_onoff_h   ("SPU IRQ Always Enabled", 0, Config.SpuIrq, 1, h_cfg_spuirq),
 	mee_onoff_h   ("Rootcounter hack",       0, Config.RCntFix, 1, h_cfg_rcnt1),
 	mee_onoff_h   ("Rootcounter hack 2",     0, Config.VSyncWA, 1, h_cfg_rcnt2),
+	mee_onoff_h   ("Accurate CPU timing",    0, Config.CycleModel, 1, h_cfg_cycles),
 	mee_onoff_h   ("Disable dynarec (slow!)",0, Config.Cpu, 1, h_cfg_nodrc),
 	mee_end,
 };
@@ -1343,6 +1349,7 @@ static int run_bios(void)
 	if (bios_sel == 0)
 		return -1;
 
+	emu_drc_cache_save();
 	ready_to_go = 0;
 	pl_fbdev_buf = NULL;
 
@@ -1350,6 +1357,7 @@ static int run_bios(void)
 	set_cd_image(NULL);
 	LoadPlugins();
 	pcnt_hook_plugins();
+	gpu_rec_hook_plugins();
 	NetOpened = 0;
 	if (OpenPlugins() == -1) {
 		me_update_msg("failed to open plugins");
@@ -1375,6 +1383,7 @@ static int run_cd_image(const char *fname)
 	set_cd_image(fname);
 	LoadPlugins();
 	pcnt_hook_plugins();
+	gpu_rec_hook_plugins();
 	NetOpened = 0;
 	if (OpenPlugins() == -1) {
 		me_update_msg("failed to open plugins");
@@ -1413,6 +1422,7 @@ static int romsel_run(void)
 
 	printf("selected file: %s\n", fname);
 
+	emu_drc_cache_save();
 	new_dynarec_clear_full();
 
 	if (run_cd_image(fname) != 0)
@@ -1431,6 +1441,8 @@ static int romsel_run(void)
 			return -1;
 	}
 
+	emu_drc_cache_load();
+
 	strcpy(last_selected_fname, rom_fname_reload);
 	return 0;
 }
@@ -1755,7 +1767,13 @@ void menu_prepare_emu(void)
 	}
 
 	psxCpu = (Config.Cpu == CPU_INTERPRETER) ? &psxInt : &psxRec;
-	if (psxCpu != prev_cpu)
+	if (new_dynarec_cycle_model >= 0 && new_dynarec_cycle_model != Config.CycleModel) {
+		// instruction timing is compiled into the blocks,
+		// dirty ones would come back on their own
+		new_dynarec_clear_full();
+		psxCpu->Reset();
+	}
+	else if (psxCpu != prev_cpu)
 		// note that this does not really reset, just clears drc caches
 		psxCpu->Reset();
 
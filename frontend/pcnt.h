@@ -77,6 +77,8 @@ static inline unsigned int pcnt_get(void)
 #ifdef __ARM_ARCH_7A__
 	__asm__ volatile("mrc p15, 0, %0, c9, c13, 0"
 			 : "=r"(val));
+#elif defined(__i386__) || defined(__x86_64__)
+	__asm__ volatile("rdtsc" : "=a"(val) :: "edx");
 #else
 	val = 0;
 #endif
@@ -43,14 +43,6 @@ void plat_finish(void)
 {
 }
 
-void bgr555_to_rgb565(void *d, void *s, int len)
-{
-}
-
-void bgr888_to_rgb888(void *d, void *s, int len)
-{
-}
-
 void in_update_analogs(void)
 {
 }
@@ -63,19 +63,19 @@ static int get_cpu_ticks(void)
 static void print_hud(void)
 {
 	if (pl_fbdev_bpp == 16)
-		pl_text_out16(2, pl_fbdev_h - 10, "%s", hud_msg);
+		pl_text_out16(2, pl_fbdev_h - PL_HUD_LINES, "%s", hud_msg);
 }
 
 static void print_fps(void)
 {
 	if (pl_fbdev_bpp == 16)
-		pl_text_out16(2, pl_fbdev_h - 10, "%2d %4.1f", flips_per_sec, vsps_cur);
+		pl_text_out16(2, pl_fbdev_h - PL_HUD_LINES, "%2d %4.1f", flips_per_sec, vsps_cur);
 }
 
 static void print_cpu_usage(void)
 {
 	if (pl_fbdev_bpp == 16)
-		pl_text_out16(pl_fbdev_w - 28, pl_fbdev_h - 10, "%3d", tick_per_sec);
+		pl_text_out16(pl_fbdev_w - 28, pl_fbdev_h - PL_HUD_LINES, "%3d", tick_per_sec);
 }
 
 void *pl_fbdev_set_mode(int w, int h, int bpp)
@@ -22,6 +22,9 @@ void in_update_analogs(void);
 
 extern void *pl_fbdev_buf;
 
+/* bottom lines of the framebuffer the frontend may print text over */
+#define PL_HUD_LINES 10
+
 int   pl_fbdev_open(void);
 void *pl_fbdev_set_mode(int w, int h, int bpp);
 void *pl_fbdev_flip(void);
@@ -1985,7 +1985,7 @@ void psxDma3(u32 madr, u32 bcr, u32 chcr) {
 				memcpy(ptr, cdr.pTransfer, cdsize);
 			}
 
-			psxCpu->Clear(madr, cdsize / 4);
+			psxMemClearCode(madr, cdsize / 4);
 			cdr.pTransfer += cdsize;
 
 
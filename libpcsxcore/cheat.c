@@ -22,6 +22,10 @@
 
 #include "cheat.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 Cheat *Cheats = NULL;
 int NumCheats = 0;
 static int NumCheatsAllocated = 0;
@@ -33,10 +37,36 @@ static int NumCodesAllocated = 0;
 s8 *prevM = NULL;
 u32 *SearchResults = NULL;
 int NumSearchResults = 0;
-static int NumSearchResultsAllocated = 0;
 
 #define ALLOC_INCREMENT		100
 
+// enabled cheats, pre-decoded into a flat list that ApplyCheats() just runs.
+// there is one op per code so that conditionals can keep skipping exactly
+// one code, even when that is the first half of a slide or memcpy.
+typedef struct {
+	u8			type;
+	u8			adv;		// ops to advance after this one
+	u16			val;
+	u8			*p;			// target in psxM
+	u8			*src;		// CHEAT_MEMCPY source, NULL if it needs the slow path
+	u32			addr;		// psxM offset, for the slow paths
+	u32			taddr;
+	u16			count;		// slide count / memcpy length
+	s8			step;		// slide address step
+	s8			inc;		// slide value increment
+} CheatOp;
+
+#define CHEAT_OP_NOP		0x00
+#define CHEAT_OP_SLIDE8		(CHEAT_CONST8 | 1)
+#define CHEAT_OP_SLIDE16	(CHEAT_CONST16 | 1)
+
+static CheatOp *CheatOps = NULL;
+static int NumCheatOps = 0;
+static int CheatsDirty = 1;
+static s8 *CheatOpsBase = NULL;		// psxM the ops were resolved against
+static char *CompiledEnabled = NULL;
+static int NumCompiled = 0;
+
 void ClearAllCheats() {
 	int i;
 
@@ -58,6 +88,11 @@ void ClearAllCheats() {
 	CheatCodes = NULL;
 	NumCodes = 0;
 	NumCodesAllocated = 0;
+
+	free(CheatOps);
+	CheatOps = NULL;
+	NumCheatOps = 0;
+	CheatsDirty = 1;
 }
 
 // load cheats from the specific filename
@@ -179,125 +214,229 @@ void SaveCheats(const char *filename) {
 	SysPrintf(_("Cheats saved to: %s\n"), filename);
 }
 
-// apply all enabled cheats
-void ApplyCheats() {
-	int		i, j, k, endindex;
+static int CheatsChanged() {
+	int i;
+
+	if (CheatsDirty || CheatOpsBase != psxM || NumCompiled != NumCheats)
+		return 1;
+
+	for (i = 0; i < NumCheats; i++) {
+		if ((Cheats[i].Enabled != 0) != CompiledEnabled[i])
+			return 1;
+	}
+
+	return 0;
+}
+
+static void CompileCheats() {
+	int		i, j, endindex, n = 0;
+	CheatOp	*op;
+
+	free(CheatOps);
+	free(CompiledEnabled);
+	CheatOps = NumCodes ? malloc(sizeof(CheatOp) * NumCodes) : NULL;
+	CompiledEnabled = NumCheats ? malloc(NumCheats) : NULL;
 
 	for (i = 0; i < NumCheats; i++) {
+		CompiledEnabled[i] = Cheats[i].Enabled != 0;
 		if (!Cheats[i].Enabled) {
 			continue;
 		}
 
-		// process all cheat codes
 		endindex = Cheats[i].First + Cheats[i].n;
 
 		for (j = Cheats[i].First; j < endindex; j++) {
 			u8		type = (uint8_t)(CheatCodes[j].Addr >> 24);
 			u32		addr = (CheatCodes[j].Addr & 0x001FFFFF);
 			u16		val = CheatCodes[j].Val;
-			u32		taddr;
+
+			op = &CheatOps[n];
+			memset(op, 0, sizeof(*op));
+			op->type = type;
+			op->adv = 1;
+			op->val = val;
+			op->addr = addr;
+			op->p = &psxMu8ref(addr);
 
 			switch (type) {
 				case CHEAT_CONST8:
-					psxMu8ref(addr) = (u8)val;
-					break;
-
 				case CHEAT_CONST16:
-					psxMu16ref(addr) = SWAPu16(val);
-					break;
-
 				case CHEAT_INC16:
-					psxMu16ref(addr) = SWAPu16(psxMu16(addr) + val);
-					break;
-
 				case CHEAT_DEC16:
-					psxMu16ref(addr) = SWAPu16(psxMu16(addr) - val);
-					break;
-
 				case CHEAT_INC8:
-					psxMu8ref(addr) += (u8)val;
-					break;
-
 				case CHEAT_DEC8:
-					psxMu8ref(addr) -= (u8)val;
 					break;
 
 				case CHEAT_SLIDE:
-					j++;
-					if (j >= endindex)
+					if (j + 1 >= endindex) {
+						op->type = CHEAT_OP_NOP;
 						break;
-
-					type = (uint8_t)(CheatCodes[j].Addr >> 24);
-					taddr = (CheatCodes[j].Addr & 0x001FFFFF);
-					val = CheatCodes[j].Val;
-
-					if (type == CHEAT_CONST8) {
-						for (k = 0; k < ((addr >> 8) & 0xFF); k++) {
-							psxMu8ref(taddr) = (u8)val;
-							taddr += (s8)(addr & 0xFF);
-							val += (s8)(CheatCodes[j - 1].Val & 0xFF);
-						}
 					}
-					else if (type == CHEAT_CONST16) {
-						for (k = 0; k < ((addr >> 8) & 0xFF); k++) {
-							psxMu16ref(taddr) = SWAPu16(val);
-							taddr += (s8)(addr & 0xFF);
-							val += (s8)(CheatCodes[j - 1].Val & 0xFF);
-						}
+					op->adv = 2;
+					switch ((uint8_t)(CheatCodes[j + 1].Addr >> 24)) {
+						case CHEAT_CONST8:  op->type = CHEAT_OP_SLIDE8; break;
+						case CHEAT_CONST16: op->type = CHEAT_OP_SLIDE16; break;
+						default:            op->type = CHEAT_OP_NOP; break;
 					}
+					op->taddr = (CheatCodes[j + 1].Addr & 0x001FFFFF);
+					op->val = CheatCodes[j + 1].Val;
+					op->count = (addr >> 8) & 0xFF;
+					op->step = (s8)(addr & 0xFF);
+					op->inc = (s8)(val & 0xFF);
 					break;
 
 				case CHEAT_MEMCPY:
-					j++;
-					if (j >= endindex)
+					if (j + 1 >= endindex) {
+						op->type = CHEAT_OP_NOP;
 						break;
-
-					taddr = (CheatCodes[j].Addr & 0x001FFFFF);
-					for (k = 0; k < val; k++) {
-						psxMu8ref(taddr + k) = PSXMu8(addr + k);
 					}
+					op->adv = 2;
+					op->taddr = (CheatCodes[j + 1].Addr & 0x001FFFFF);
+					op->count = val;
+					op->p = &psxMu8ref(op->taddr);
+					// byte copy loop is only a plain memcpy if nothing wraps or overlaps
+					if (addr + val <= 0x200000 && op->taddr + val <= 0x200000 &&
+					    (op->taddr + val <= addr || addr + val <= op->taddr))
+						op->src = &psxMu8ref(addr);
 					break;
 
 				case CHEAT_EQU8:
-					if (PSXMu8(addr) != (u8)val)
-						j++; // skip the next code
-					break;
-
 				case CHEAT_NOTEQU8:
-					if (PSXMu8(addr) == (u8)val)
-						j++; // skip the next code
-					break;
-
 				case CHEAT_LESSTHAN8:
-					if (PSXMu8(addr) >= (u8)val)
-						j++; // skip the next code
-					break;
-
 				case CHEAT_GREATERTHAN8:
-					if (PSXMu8(addr) <= (u8)val)
-						j++; // skip the next code
-					break;
-
 				case CHEAT_EQU16:
-					if (PSXMu16(addr) != val)
-						j++; // skip the next code
-					break;
-
 				case CHEAT_NOTEQU16:
-					if (PSXMu16(addr) == val)
-						j++; // skip the next code
-					break;
-
 				case CHEAT_LESSTHAN16:
-					if (PSXMu16(addr) >= val)
-						j++; // skip the next code
+				case CHEAT_GREATERTHAN16:
+					// nothing to skip in the last code, the test has no effect
+					if (j + 1 >= endindex)
+						op->type = CHEAT_OP_NOP;
 					break;
 
-				case CHEAT_GREATERTHAN16:
-					if (PSXMu16(addr) <= val)
-						j++; // skip the next code
+				default:
+					op->type = CHEAT_OP_NOP;
 					break;
 			}
+			n++;
+		}
+	}
+
+	NumCheatOps = n;
+	NumCompiled = NumCheats;
+	CheatOpsBase = psxM;
+	CheatsDirty = 0;
+}
+
+// apply all enabled cheats
+void ApplyCheats() {
+	CheatOp	*op, *end;
+	u32		taddr;
+	u16		val;
+	int		k, adv;
+
+	if (NumCheats == 0)
+		return;
+	if (CheatsChanged())
+		CompileCheats();
+
+	for (op = CheatOps, end = CheatOps + NumCheatOps; op < end; op += adv) {
+		adv = op->adv;
+
+		switch (op->type) {
+			case CHEAT_CONST8:
+				*op->p = (u8)op->val;
+				break;
+
+			case CHEAT_CONST16:
+				*(u16 *)op->p = SWAPu16(op->val);
+				break;
+
+			case CHEAT_INC16:
+				*(u16 *)op->p = SWAPu16(SWAP16(*(u16 *)op->p) + op->val);
+				break;
+
+			case CHEAT_DEC16:
+				*(u16 *)op->p = SWAPu16(SWAP16(*(u16 *)op->p) - op->val);
+				break;
+
+			case CHEAT_INC8:
+				*op->p += (u8)op->val;
+				break;
+
+			case CHEAT_DEC8:
+				*op->p -= (u8)op->val;
+				break;
+
+			case CHEAT_OP_SLIDE8:
+				taddr = op->taddr;
+				val = op->val;
+				for (k = 0; k < op->count; k++) {
+					psxMu8ref(taddr) = (u8)val;
+					taddr += op->step;
+					val += op->inc;
+				}
+				break;
+
+			case CHEAT_OP_SLIDE16:
+				taddr = op->taddr;
+				val = op->val;
+				for (k = 0; k < op->count; k++) {
+					psxMu16ref(taddr) = SWAPu16(val);
+					taddr += op->step;
+					val += op->inc;
+				}
+				break;
+
+			case CHEAT_MEMCPY:
+				if (op->src != NULL) {
+					memcpy(op->p, op->src, op->count);
+					break;
+				}
+				for (k = 0; k < op->count; k++) {
+					psxMu8ref(op->taddr + k) = PSXMu8(op->addr + k);
+				}
+				break;
+
+			// conditionals skip the next code when false
+			case CHEAT_EQU8:
+				if (*op->p != (u8)op->val)
+					adv = 2;
+				break;
+
+			case CHEAT_NOTEQU8:
+				if (*op->p == (u8)op->val)
+					adv = 2;
+				break;
+
+			case CHEAT_LESSTHAN8:
+				if (*op->p >= (u8)op->val)
+					adv = 2;
+				break;
+
+			case CHEAT_GREATERTHAN8:
+				if (*op->p <= (u8)op->val)
+					adv = 2;
+				break;
+
+			case CHEAT_EQU16:
+				if (SWAP16(*(u16 *)op->p) != op->val)
+					adv = 2;
+				break;
+
+			case CHEAT_NOTEQU16:
+				if (SWAP16(*(u16 *)op->p) == op->val)
+					adv = 2;
+				break;
+
+			case CHEAT_LESSTHAN16:
+				if (SWAP16(*(u16 *)op->p) >= op->val)
+					adv = 2;
+				break;
+
+			case CHEAT_GREATERTHAN16:
+				if (SWAP16(*(u16 *)op->p) <= op->val)
+					adv = 2;
+				break;
 		}
 	}
 }
@@ -371,6 +510,7 @@ int AddCheat(const char *descr, char *code) {
 	}
 
 	NumCheats++;
+	CheatsDirty = 1;
 	return 0;
 }
 
@@ -385,6 +525,7 @@ void RemoveCheat(int index) {
 	}
 
 	NumCheats--;
+	CheatsDirty = 1;
 }
 
 int EditCheat(int index, const char *descr, char *code) {
@@ -443,6 +584,7 @@ int EditCheat(int index, const char *descr, char *code) {
 	Cheats[index].Descr = strdup(descr[0] ? descr : _("(Untitled)"));
 	Cheats[index].First = prev;
 	Cheats[index].n = NumCodes - prev;
+	CheatsDirty = 1;
 
 	return 0;
 }
@@ -454,7 +596,6 @@ void FreeCheatSearchResults() {
 	SearchResults = NULL;
 
 	NumSearchResults = 0;
-	NumSearchResultsAllocated = 0;
 }
 
 void FreeCheatSearchMem() {
@@ -477,19 +618,131 @@ static void CheatSearchInitBackupMemory() {
 	}
 }
 
-static void CheatSearchAddResult(u32 addr) {
-	if (NumSearchResults >= NumSearchResultsAllocated) {
-		NumSearchResultsAllocated += ALLOC_INCREMENT;
+// first searches go over all of RAM: matches are collected into a bitmap
+// (one bit per byte address, 16 addresses per SIMD compare), then turned
+// into the result list in one go instead of growing it per address
+enum { CS_EQUAL, CS_NOTEQUAL, CS_RANGE };
+
+#define SEARCH_MAP_SIZE		(0x200000 / 8)
+
+#ifdef __SSE2__
+static u32 CheatSearchMaskSSE2(const u8 *p, int size, int op,
+	__m128i va, __m128i vb)
+{
+	__m128i x = _mm_loadu_si128((const __m128i *)p), m;
+	u32 mask;
+
+	if (op == CS_RANGE) {
+		switch (size) {
+		case 1:
+			m = _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(x, va), x),
+				_mm_cmpeq_epi8(_mm_min_epu8(x, vb), x));
+			break;
+		case 2: // no unsigned compares, bias to signed (va/vb come biased)
+			x = _mm_xor_si128(x, _mm_set1_epi16(0x8000));
+			m = _mm_or_si128(_mm_cmpgt_epi16(va, x), _mm_cmpgt_epi16(x, vb));
+			m = _mm_xor_si128(m, _mm_set1_epi32(-1));
+			break;
+		default:
+			x = _mm_xor_si128(x, _mm_set1_epi32(0x80000000));
+			m = _mm_or_si128(_mm_cmpgt_epi32(va, x), _mm_cmpgt_epi32(x, vb));
+			m = _mm_xor_si128(m, _mm_set1_epi32(-1));
+			break;
+		}
+	}
+	else {
+		switch (size) {
+		case 1:  m = _mm_cmpeq_epi8(x, va); break;
+		case 2:  m = _mm_cmpeq_epi16(x, va); break;
+		default: m = _mm_cmpeq_epi32(x, va); break;
+		}
+	}
 
-		if (SearchResults == NULL) {
-			SearchResults = (u32 *)malloc(sizeof(u32) * NumSearchResultsAllocated);
+	mask = _mm_movemask_epi8(m);
+	if (op == CS_NOTEQUAL)
+		mask = ~mask & 0xffff;
+
+	// only keep the bit of the lowest byte of each element
+	return mask & (size == 1 ? 0xffff : size == 2 ? 0x5555 : 0x1111);
+}
+#endif
+
+static void CheatSearchScan(u8 *map, int size, int op, u32 a, u32 b) {
+#ifdef __SSE2__
+	u16 *map16 = (u16 *)map;
+	__m128i va, vb;
+	u32 i;
+
+	switch (size) {
+	case 1:
+		va = _mm_set1_epi8(a); vb = _mm_set1_epi8(b);
+		break;
+	case 2:
+		if (op == CS_RANGE) { a ^= 0x8000; b ^= 0x8000; }
+		va = _mm_set1_epi16(a); vb = _mm_set1_epi16(b);
+		break;
+	default:
+		if (op == CS_RANGE) { a ^= 0x80000000; b ^= 0x80000000; }
+		va = _mm_set1_epi32(a); vb = _mm_set1_epi32(b);
+		break;
+	}
+
+	for (i = 0; i < 0x200000; i += 16)
+		map16[i >> 4] = CheatSearchMaskSSE2((u8 *)psxM + i, size, op, va, vb);
+#else
+	u32 *map32 = (u32 *)map;
+	u32 i, k, v, bits;
+	int m;
+
+	for (i = 0; i < 0x200000; i += 32) {
+		for (bits = 0, k = 0; k < 32; k += size) {
+			switch (size) {
+				case 1:  v = psxMu8(i + k); break;
+				case 2:  v = psxMu16(i + k); break;
+				default: v = psxMu32(i + k); break;
+			}
+
+			switch (op) {
+				case CS_EQUAL:    m = v == a; break;
+				case CS_NOTEQUAL: m = v != a; break;
+				default:          m = v >= a && v <= b; break;
+			}
+
+			bits |= (u32)m << k;
 		}
-		else {
-			SearchResults = (u32 *)realloc(SearchResults, sizeof(u32) * NumSearchResultsAllocated);
+		map32[i >> 5] = SWAP32(bits);
+	}
+#endif
+}
+
+static void CheatSearchFirst(int size, int op, u32 a, u32 b) {
+	u32 *map, w, i, n = 0;
+
+	map = malloc(SEARCH_MAP_SIZE);
+	if (map == NULL)
+		return;
+
+	CheatSearchScan((u8 *)map, size, op, a, b);
+
+	for (i = 0; i < SEARCH_MAP_SIZE / 4; i++)
+		n += __builtin_popcount(map[i]);
+
+	FreeCheatSearchResults();
+	if (n != 0) {
+		SearchResults = (u32 *)malloc(sizeof(u32) * n);
+		if (SearchResults == NULL) {
+			free(map);
+			return;
 		}
 	}
 
-	SearchResults[NumSearchResults++] = addr;
+	for (i = 0; i < SEARCH_MAP_SIZE / 4; i++) {
+		// bitmap words are byte arrays, little endian order
+		for (w = SWAP32(map[i]); w != 0; w &= w - 1)
+			SearchResults[NumSearchResults++] = i * 32 + __builtin_ctz(w);
+	}
+
+	free(map);
 }
 
 void CheatSearchEqual8(u8 val) {
@@ -499,11 +752,7 @@ void CheatSearchEqual8(u8 val) {
 
 	if (SearchResults == NULL) {
 		// search the whole memory
-		for (i = 0; i < 0x200000; i++) {
-			if (PSXMu8(i) == val) {
-				CheatSearchAddResult(i);
-			}
-		}
+		CheatSearchFirst(1, CS_EQUAL, val, val);
 	}
 	else {
 		// only search within the previous results
@@ -526,11 +775,7 @@ void CheatSearchEqual16(u16 val) {
 
 	if (SearchResults == NULL) {
 		// search the whole memory
-		for (i = 0; i < 0x200000; i += 2) {
-			if (PSXMu16(i) == val) {
-				CheatSearchAddResult(i);
-			}
-		}
+		CheatSearchFirst(2, CS_EQUAL, val, val);
 	}
 	else {
 		// only search within the previous results
@@ -553,11 +798,7 @@ void CheatSearchEqual32(u32 val) {
 
 	if (SearchResults == NULL) {
 		// search the whole memory
-		for (i = 0; i < 0x200000; i += 4) {
-			if (PSXMu32(i) == val) {
-				CheatSearchAddResult(i);
-			}
-		}
+		CheatSearchFirst(4, CS_EQUAL, val, val);
 	}
 	else {
 		// only search within the previous results
@@ -580,11 +821,7 @@ void CheatSearchNotEqual8(u8 val) {
 
 	if (SearchResults == NULL) {
 		// search the whole memory
-		for (i = 0; i < 0x200000; i++) {
-			if (PSXMu8(i) != val) {
-				CheatSearchAddResult(i);
-			}
-		}
+		CheatSearchFirst(1, CS_NOTEQUAL, val, val);
 	}
 	else {
 		// only search within the previous results
@@ -607,11 +844,7 @@ void CheatSearchNotEqual16(u16 val) {
 
 	if (SearchResults == NULL) {
 		// search the whole memory
-		for (i = 0; i < 0x200000; i += 2) {
-			if (PSXMu16(i) != val) {
-				CheatSearchAddResult(i);
-			}
-		}
+		CheatSearchFirst(2, CS_NOTEQUAL, val, val);
 	}
 	else {
 		// only search within the previous results
@@ -634,11 +867,7 @@ void CheatSearchNotEqual32(u32 val) {
 
 	if (SearchResults == NULL) {
 		// search the whole memory
-		for (i = 0; i < 0x200000; i += 4) {
-			if (PSXMu32(i) != val) {
-				CheatSearchAddResult(i);
-			}
-		}
+		CheatSearchFirst(4, CS_NOTEQUAL, val, val);
 	}
 	else {
 		// only search within the previous results
@@ -661,11 +890,7 @@ void CheatSearchRange8(u8 min, u8 max) {
 
 	if (SearchResults == NULL) {
 		// search the whole memory
-		for (i = 0; i < 0x200000; i++) {
-			if (PSXMu8(i) >= min && PSXMu8(i) <= max) {
-				CheatSearchAddResult(i);
-			}
-		}
+		CheatSearchFirst(1, CS_RANGE, min, max);
 	}
 	else {
 		// only search within the previous results
@@ -688,11 +913,7 @@ void CheatSearchRange16(u16 min, u16 max) {
 
 	if (SearchResults == NULL) {
 		// search the whole memory
-		for (i = 0; i < 0x200000; i += 2) {
-			if (PSXMu16(i) >= min && PSXMu16(i) <= max) {
-				CheatSearchAddResult(i);
-			}
-		}
+		CheatSearchFirst(2, CS_RANGE, min, max);
 	}
 	else {
 		// only search within the previous results
@@ -715,11 +936,7 @@ void CheatSearchRange32(u32 min, u32 max) {
 
 	if (SearchResults == NULL) {
 		// search the whole memory
-		for (i = 0; i < 0x200000; i += 4) {
-			if (PSXMu32(i) >= min && PSXMu32(i) <= max) {
-				CheatSearchAddResult(i);
-			}
-		}
+		CheatSearchFirst(4, CS_RANGE, min, max);
 	}
 	else {
 		// only search within the previous results
@@ -58,6 +58,7 @@ char* disR3000AF(u32 code, u32 pc);
 //#define PSXDMA_LOG  __Log
 //#define PSXMEM_LOG  __Log("%8.8lx %8.8lx: ", psxRegs.pc, psxRegs.cycle); __Log
 //#define PSXCPU_LOG  __Log
+//#define HLESIG_LOG  __Log
 
 //#define CDRCMD_DEBUG
 
@@ -29,6 +29,8 @@ extern "C" {
 #include "psxcommon.h"
 #include "r3000a.h"
 
+extern const char gte_cycletab[64];
+
 void gteMFC2();
 void gteCFC2();
 void gteMTC2();
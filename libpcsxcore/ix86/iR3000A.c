@@ -2877,12 +2877,14 @@ static void recRecompile() {
 
 		if (branch) {
 			branch = 0;
+			psxMemMarkCode(pcold, pc - pcold);
 			if (dump) iDumpBlock(ptr);
 			return;
 		}
 	}
 
 	iFlushRegs();
+	psxMemMarkCode(pcold, pc - pcold);
 
 	MOV32ItoM((u32)&psxRegs.pc, pc);
 
@@ -44,6 +44,9 @@ uptr* psxRecLUT;
 
 #define RECMEM_SIZE		(PTRMULT * 8 * 1024 * 1024)
 
+/* kept in the image so that psxRegs and friends are in rip-relative range */
+static char recMemBuf[RECMEM_SIZE + PTRMULT*0x1000] __attribute__((aligned(4096)));
+
 static char *recMem;	/* the recompiled blocks will be here */
 static char *recRAM;	/* and the ptr to the blocks here */
 static char *recROM;	/* and here */
@@ -406,20 +409,28 @@ static void recRecompile();
 static int recInit() {
 	int i;
 
-	psxRecLUT = (uptr*) malloc(0x010000 * sizeof(uptr));
+	if (mprotect(recMemBuf, sizeof(recMemBuf),
+			PROT_EXEC | PROT_WRITE | PROT_READ) != 0) {
+		SysMessage("Error making recompiler memory executable"); return -1;
+	}
 
-	recMem = mmap(0,
-		RECMEM_SIZE + PTRMULT*0x1000,
-		PROT_EXEC | PROT_WRITE | PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	psxRecLUT = (uptr*) malloc(0x010000 * sizeof(uptr));
 
 	recRAM = mmap(0,
 		0x280000*PTRMULT,
 		PROT_WRITE | PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-	recROM = &recRAM[0x200000*PTRMULT];
+	if (recRAM == MAP_FAILED)
+		recRAM = NULL;
 
-	if (recRAM == NULL || recROM == NULL || recMem == NULL || psxRecLUT == NULL) {
-		SysMessage("Error allocating memory"); return -1;
+	if (recRAM == NULL || psxRecLUT == NULL) {
+		SysMessage("Error allocating memory");
+		free(psxRecLUT); psxRecLUT = NULL;
+		if (recRAM != NULL) munmap(recRAM, 0x280000*PTRMULT);
+		recRAM = NULL;
+		return -1;
 	}
+	recMem = recMemBuf;
+	recROM = &recRAM[0x200000*PTRMULT];
 	memset(recMem, 0, RECMEM_SIZE);
 	memset(recRAM, 0, 0x200000 * PTRMULT);
 	memset(recROM, 0, 0x080000 * PTRMULT);
@@ -434,11 +445,15 @@ static int recInit() {
 }
 
 static void recReset() {
+	// the frontend may switch to us without init, see menu_prepare_emu()
+	if (recMem == NULL && recInit() != 0)
+		return;
+
 	memset(recRAM, 0, 0x200000 * PTRMULT);
 	memset(recROM, 0, 0x080000 * PTRMULT);
 
-	//x86Init();
-	cpudetectInit();
+	// no cpudetectInit() here, it spends a second measuring the clock
+	// and we get reset each time the block cache fills up
 	x86SetPtr(recMem);
 
 	branch = 0;
@@ -450,8 +465,11 @@ static void recReset() {
 static void recShutdown() {
 	if (recMem == NULL) return;
 	free(psxRecLUT);
-	munmap(recMem, RECMEM_SIZE + PTRMULT*0x1000);
+	psxRecLUT = NULL;
 	munmap(recRAM, 0x280000*PTRMULT);
+	recRAM = recROM = NULL;
+	mprotect(recMemBuf, sizeof(recMemBuf), PROT_WRITE | PROT_READ);
+	recMem = NULL;
 	x86Shutdown();
 }
 
@@ -483,7 +501,10 @@ static void recError() {
 }
 
 static void recExecute() {
-	for (;;) execute();
+	extern int stop;
+
+	while (!stop)
+		execute();
 }
 
 static void recExecuteBlock() {
@@ -2807,7 +2828,10 @@ static void recRFE() {
 static void recHLE() {
 	iFlushRegs();
 
-	CALLFunc((uptr)psxHLEt[psxRegs.code & 0xffff]);
+	// the upper bits are an argument (native index), and the handlers
+	// find the opcode through pc
+	MOV32ItoM((uptr)&psxRegs.pc, pc);
+	CALLFunc((uptr)psxHLEt[psxRegs.code & 0x07]);
 	branch = 2;
 	iRet();
 }
@@ -2883,7 +2907,7 @@ static void recRecompile() {
 	x86Align(32);
 	ptr = x86Ptr;
 
-	PC_RECP(psxRegs.pc) = x86Ptr;
+	PC_RECP(psxRegs.pc) = (uptr)x86Ptr;
 	pc = psxRegs.pc;
 	pcold = pc;
 
@@ -2941,12 +2965,14 @@ static void recRecompile() {
 
 		if (branch) {
 			branch = 0;
+			psxMemMarkCode(pcold, pc - pcold);
 			if (dump) iDumpBlock(ptr);
 			return;
 		}
 	}
 
 	iFlushRegs();
+	psxMemMarkCode(pcold, pc - pcold);
 
 	MOV32ItoM((uptr)&psxRegs.pc, pc);
 	iRet();
@@ -66,7 +66,7 @@ typedef int x86IntRegType;
 #define R14 14
 #define R15 15
 
-#define X86_TEMP RAX // don't allocate anything
+#define X86_TEMP R11 // don't allocate anything, R11 is never used for args or results
 
 #ifdef _MSC_VER
 extern x86IntRegType g_x86savedregs[8];
@@ -208,7 +208,7 @@ extern u32 *j32Ptr[32];
 #define X86_64ASSERT() assert(0)
 #define MEMADDR_(addr, oplen)	(sptr)((uptr)(addr) - ((uptr)x86Ptr + ((u64)(oplen))))
 #define	SPTR32(addr)		((addr) < 0x80000000L && (addr) >= -0x80000000L)
-#define	UPTR32(addr)		((addr) < 0x100000000L)
+#define	UPTR32(addr)		((addr) < 0x80000000L) // disp32 gets sign extended
 #define MEMADDR(addr, oplen)	({ sptr _a = MEMADDR_(addr, oplen); assert(SPTR32(_a)); _a; })
 #else
 #define X86_64ASSERT()
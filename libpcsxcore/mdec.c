@@ -621,6 +621,8 @@ void psxDma1(u32 adr, u32 bcr, u32 chcr) {
 		}
 	}
 	
+	psxMemClearCode(adr, dmacnt / 4);
+
 	/* define the power of mdec */
 	MDECOUTDMA_INT((int) ((dmacnt* MDEC_BIAS)));
 	}
@@ -25,6 +25,7 @@
 #include "cdrom.h"
 #include "mdec.h"
 #include "ppf.h"
+#include "psxhle.h"
 
 char CdromId[10] = "";
 char CdromLabel[33] = "";
@@ -147,6 +148,7 @@ int LoadCdrom() {
 	u8 time[4], *buf;
 	u8 mdir[4096];
 	s8 exename[256];
+	u32 addr, size;
 
 	if (!Config.HLE) {
 		psxRegs.pc = psxRegs.GPR.n.ra;
@@ -208,6 +210,8 @@ int LoadCdrom() {
 
 	tmpHead.t_size = SWAP32(tmpHead.t_size);
 	tmpHead.t_addr = SWAP32(tmpHead.t_addr);
+	addr = tmpHead.t_addr;
+	size = tmpHead.t_size;
 
 	// Read the rest of the main executable
 	while (tmpHead.t_size) {
@@ -222,6 +226,8 @@ int LoadCdrom() {
 		tmpHead.t_addr += 2048;
 	}
 
+	psxHleSigScan(addr, size);
+
 	return 0;
 }
 
@@ -257,11 +263,14 @@ int LoadCdromFile(const char *filename, EXE_HEADER *head) {
 		READTRACK();
 
 		memcpy((void *)PSXM(addr), buf + 12, 2048);
+		psxMemClearCode(addr, 2048 / 4);
 
 		size -= 2048;
 		addr += 2048;
 	}
 
+	psxHleSigScan(head->t_addr, head->t_size);
+
 	return 0;
 }
 
@@ -397,6 +406,7 @@ int Load(const char *ExePath) {
 				fseek(tmpFile, 0x800, SEEK_SET);		
 				fread((void *)PSXM(SWAP32(tmpHead.t_addr)), SWAP32(tmpHead.t_size),1,tmpFile);
 				fclose(tmpFile);
+				psxHleSigScan(SWAP32(tmpHead.t_addr), SWAP32(tmpHead.t_size));
 				psxRegs.pc = SWAP32(tmpHead.pc0);
 				psxRegs.GPR.n.gp = SWAP32(tmpHead.gp0);
 				psxRegs.GPR.n.sp = SWAP32(tmpHead.s_addr); 
@@ -1111,6 +1111,17 @@ void emit_orrshr_imm(u_int rs,u_int imm,u_int rt)
   output_w32(0xe1800020|rd_rn_rm(rt,rt,rs)|(imm<<7));
 }
 
+void emit_subsar_imm(u_int rs1,u_int rs2,u_int imm,u_int rt)
+{
+  assert(rs1<16);
+  assert(rs2<16);
+  assert(rt<16);
+  assert(imm>0);
+  assert(imm<32);
+  assem_debug("sub %s,%s,%s,asr #%d\n",regname[rt],regname[rs1],regname[rs2],imm);
+  output_w32(0xe0400040|rd_rn_rm(rt,rs1,rs2)|(imm<<7));
+}
+
 void emit_xor(u_int rs1,u_int rs2,u_int rt)
 {
   assem_debug("eor %s,%s,%s\n",regname[rt],regname[rs1],regname[rs2]);
@@ -1745,8 +1756,8 @@ void emit_popreg(u_int r)
 }
 void emit_callreg(u_int r)
 {
-  assem_debug("call *%%%s\n",regname[r]);
-  assert(0);
+  assem_debug("blx %s\n",regname[r]);
+  output_w32(0xe12fff30|r);
 }
 void emit_jmpreg(u_int r)
 {
@@ -2044,6 +2055,15 @@ void emit_smull(u_int rs1, u_int rs2, u_int hi, u_int lo)
   assert(lo<16);
   output_w32(0xe0c00090|(hi<<16)|(lo<<12)|(rs2<<8)|rs1);
 }
+void emit_smlal(u_int rs1, u_int rs2, u_int hi, u_int lo)
+{
+  assem_debug("smlal %s, %s, %s, %s\n",regname[lo],regname[hi],regname[rs1],regname[rs2]);
+  assert(rs1<16);
+  assert(rs2<16);
+  assert(hi<16);
+  assert(lo<16);
+  output_w32(0xe0e00090|(hi<<16)|(lo<<12)|(rs2<<8)|rs1);
+}
 
 void emit_div(int rs)
 {
@@ -2468,6 +2488,22 @@ void emit_orrne_imm(int rs,int imm,int rt)
   output_w32(0x13800000|rd_rn_rm(rt,rs,0)|armval);
 }
 
+void emit_orrlt_imm(int rs,int imm,int rt)
+{
+  u_int armval;
+  genimm_checked(imm,&armval);
+  assem_debug("orrlt %s,%s,#%d\n",regname[rt],regname[rs],imm);
+  output_w32(0xb3800000|rd_rn_rm(rt,rs,0)|armval);
+}
+
+void emit_orrgt_imm(int rs,int imm,int rt)
+{
+  u_int armval;
+  genimm_checked(imm,&armval);
+  assem_debug("orrgt %s,%s,#%d\n",regname[rt],regname[rs],imm);
+  output_w32(0xc3800000|rd_rn_rm(rt,rs,0)|armval);
+}
+
 void emit_andne_imm(int rs,int imm,int rt)
 {
   u_int armval;
@@ -2605,6 +2641,7 @@ emit_extjump_ds(int addr, int target)
 }
 
 #ifdef PCSX
+#include "pcsxmem.h"
 #include "pcsxmem_inline.c"
 #endif
 
@@ -2732,6 +2769,8 @@ inline_readstub(int type, int i, u_int addr, signed char regmap[], int target, i
 #ifdef PCSX
   if(pcsx_direct_read(type,addr,target?rs:-1,rt))
     return;
+  if(pcsx_direct_read_io(type,addr,rt,regmap,adj,reglist))
+    return;
 #endif
   if(target==0)
     emit_movimm(addr,rs);
@@ -2896,6 +2935,8 @@ inline_writestub(int type, int i, u_int addr, signed char regmap[], int target,
 #ifdef PCSX
   if(pcsx_direct_write(type,addr,rs,rt,regmap))
     return;
+  if(pcsx_direct_write_io(type,addr,rt,regmap,adj,reglist))
+    return;
 #endif
   int ftable=0;
   if(type==STOREB_STUB)
@@ -3084,6 +3125,12 @@ int do_dirty_stub(int i)
   emit_movimm(start+i*4,0);
   emit_call((int)start<(int)0xC0000000?(int)&verify_code:(int)&verify_code_vm);
   int entry=(int)out;
+  #ifdef DRC_PROFILE
+  // nothing is allocated yet, so r0-r3 are free here
+  emit_movimm((u_int)drc_prof_get(start+i*4,slen-i),0);
+  emit_mov(HOST_CCREG,1);
+  emit_call((int)drc_prof_enter);
+  #endif
   load_regs_entry(i);
   if(entry==(int)out) entry=instr_addr[i];
   emit_jmp(instr_addr[i]);
@@ -3754,22 +3801,104 @@ void cop2_assemble(int i,struct regstat *i_regs)
   }
 }
 
+// MAC0 from the 64-bit result in hi:lo, setting the F overflow bits in flag
+// (uses flag as scratch, hi is clobbered)
+static void c2op_mac0_flags(int lo,int hi,int flag)
+{
+  emit_adds(lo,lo,flag);   // carry=bit 31
+  emit_adcs(hi,hi,hi);     // 0 or -1 if the result fits 32 bits
+  emit_zeroreg(flag);
+  emit_cmpimm(hi,0);
+  emit_orrgt_imm(flag,0x80000000,flag);
+  emit_orrgt_imm(flag,1<<16,flag);
+  emit_cmpimm(hi,-1);
+  emit_orrlt_imm(flag,0x80000000,flag);
+  emit_orrlt_imm(flag,1<<15,flag);
+  emit_writeword(lo,(int)&reg_cop2d[24]); // MAC0
+}
+
+// The simple GTE ops are generated inline, they only touch a few registers
+// and calling out costs more than doing the work.  Uses r0-r3, r12, r14,
+// the caller has saved the guest registers cached in them.
+static void c2op_nclip(void)
+{
+  emit_readword((int)&reg_cop2d[12],0); // SXY0
+  emit_readword((int)&reg_cop2d[13],1); // SXY1
+  emit_readword((int)&reg_cop2d[14],2); // SXY2
+  emit_sarimm(1,16,3);
+  emit_sarimm(2,16,12);
+  emit_sub(3,12,HOST_TEMPREG);          // SY1-SY2
+  emit_subsar_imm(12,0,16,12);          // SY2-SY0
+  emit_subsar_imm(3,0,16,3);            // SY1-SY0
+  emit_signextend16(0,0);
+  emit_smull(0,HOST_TEMPREG,HOST_TEMPREG,2);
+  emit_signextend16(1,1);
+  emit_smlal(1,12,HOST_TEMPREG,2);
+  emit_readword((int)&reg_cop2d[14],0);
+  emit_signextend16(0,0);
+  emit_rsbimm(0,0,0);                   // -SX2*(SY1-SY0)
+  emit_smlal(0,3,HOST_TEMPREG,2);
+  c2op_mac0_flags(2,HOST_TEMPREG,1);
+  emit_writeword(1,(int)&reg_cop2c[31]); // FLAG
+}
+
+static void c2op_avsz(int four)
+{
+  int r;
+  emit_readword((int)&reg_cop2d[19],0);
+  emit_andimm(0,0xffff,0);
+  for(r=four?16:17;r<19;r++) {
+    emit_readword((int)&reg_cop2d[r],1);
+    emit_andimm(1,0xffff,1);
+    emit_add(0,1,0);
+  }
+  emit_readword((int)&reg_cop2c[four?30:29],1); // ZSF4/ZSF3
+  emit_signextend16(1,1);
+  emit_smull(0,1,3,2);
+  c2op_mac0_flags(2,3,1);
+  // OTZ=limD(MAC0>>12)
+  emit_sarimm(2,12,0);
+  emit_cmpimm(0,0x10000);
+  int jaddr=(int)out;
+  emit_jcc(0);
+  emit_orimm(1,0x80000000,1);
+  emit_orimm(1,1<<18,1);
+  emit_sarimm(0,31,0);
+  emit_not(0,0);
+  emit_shrimm(0,16,0);
+  set_jump_target(jaddr,(int)out);
+  emit_readword((int)&reg_cop2d[7],3);
+  emit_shrimm(3,16,3);
+  emit_orrshl_imm(3,16,0);
+  emit_writeword(0,(int)&reg_cop2d[7]);
+  emit_writeword(1,(int)&reg_cop2c[31]); // FLAG
+}
+
 void c2op_assemble(int i,struct regstat *i_regs)
 {
   signed char temp=get_reg(i_regs->regmap,-1);
   u_int c2op=source[i]&0x3f;
   u_int hr,reglist=0;
+  int cc=get_reg(i_regs->regmap,CCREG);
+  int cycles=Config.CycleModel?0:gte_cycletab[c2op]/2; // else in ccadj
   for(hr=0;hr<HOST_REGS;hr++) {
     if(i_regs->regmap[hr]>=0) reglist|=1<<hr;
   }
   if(i==0||itype[i-1]!=C2OP)
     save_regs(reglist);
 
-  if (gte_handlers[c2op]!=NULL) {
-    int cc=get_reg(i_regs->regmap,CCREG);
+  if (c2op==0x06||c2op==0x2d||c2op==0x2e) {
+    if (cc>=0&&cycles)
+      emit_addimm(cc,cycles,cc);
+    if (c2op==0x06)
+      c2op_nclip();
+    else
+      c2op_avsz(c2op==0x2e);
+  }
+  else if (gte_handlers[c2op]!=NULL) {
     emit_movimm(source[i],1); // opcode
-    if (cc>=0&&gte_cycletab[c2op])
-      emit_addimm(cc,gte_cycletab[c2op]/2,cc); // XXX: could just adjust ccadj?
+    if (cc>=0&&cycles)
+      emit_addimm(cc,cycles,cc);
     emit_addimm(FP,(int)&psxRegs.CP2D.r[0]-(int)&dynarec_local,0); // cop2 regs
     emit_writeword(1,(int)&psxRegs.code);
     emit_call((int)gte_handlers[c2op]);
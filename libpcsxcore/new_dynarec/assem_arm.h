@@ -49,7 +49,15 @@
 extern char *invc_ptr;
 
 #define BASE_ADDR 0x1000000 // Code generator target address
+#ifndef TARGET_SIZE_2
 #define TARGET_SIZE_2 24 // 2^24 = 16 megabytes
+#endif
+// The default is already the largest size, this can only shrink it.
+// The upper limit is bl reach from the end of the cache to the main
+// binary, the lower one is 8 expiry slices of a few blocks each.
+#if TARGET_SIZE_2 > 24 || TARGET_SIZE_2 < 22
+#error TARGET_SIZE_2 out of range
+#endif
 
 // This is defined in linkage_arm.s, but gcc -O3 likes this better
 #define rdram ((unsigned int *)0x80000000)
@@ -140,15 +140,6 @@ void new_dyna_restore(void)
 
 void *gte_handlers[64];
 
-/* from gte.txt.. not sure if this is any good. */
-const char gte_cycletab[64] = {
-	/*   1   2   3   4   5   6   7   8   9   a   b   c   d   e   f */
-	 0, 15,  0,  0,  0,  0,  8,  0,  0,  0,  0,  0,  6,  0,  0,  0,
-	 8,  8,  8, 19, 13,  0, 44,  0,  0,  0,  0, 17, 11,  0, 14,  0,
-	30,  0,  0,  0,  0,  0,  0,  0,  5,  8, 17,  0,  0,  5,  6,  0,
-	23,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  5,  5, 39,
-};
-
 static int ari64_init()
 {
 	extern void (*psxCP2[64])();
@@ -181,6 +172,11 @@ static void ari64_reset()
 	pending_exception = 1;
 }
 
+#ifdef DRC_PROFILE
+static void drc_prof_leave(void);
+static void drc_prof_report(const char *fname);
+#endif
+
 // execute until predefined leave points
 // (HLE softcall exit and BIOS fastboot end)
 static void ari64_execute_until()
@@ -191,6 +187,9 @@ static void ari64_execute_until()
 		psxRegs.cycle, next_interupt, next_interupt - psxRegs.cycle);
 
 	new_dyna_start();
+#ifdef DRC_PROFILE
+	drc_prof_leave();
+#endif
 
 	evprintf("ari64_execute end %08x, %u->%u (%d)\n", psxRegs.pc,
 		psxRegs.cycle, next_interupt, next_interupt - psxRegs.cycle);
@@ -225,6 +224,9 @@ static void ari64_clear(u32 addr, u32 size)
 
 static void ari64_shutdown()
 {
+#ifdef DRC_PROFILE
+	drc_prof_report("drc_profile.txt");
+#endif
 	new_dynarec_cleanup();
 }
 
@@ -237,6 +239,7 @@ extern void intExecuteBlockT();
 #define intExecuteBlockT intExecuteBlock
 #endif
 
+#ifndef USE_IX86_64 // has its own psxRec
 R3000Acpu psxRec = {
 	ari64_init,
 	ari64_reset,
@@ -250,6 +253,7 @@ R3000Acpu psxRec = {
 	ari64_clear,
 	ari64_shutdown
 };
+#endif
 
 // TODO: rm
 #ifndef DRC_DBG
@@ -264,10 +268,13 @@ unsigned char byte;
 int pending_exception, stop;
 unsigned int next_interupt;
 void *psxH_ptr;
+int new_dynarec_cycle_model = -1;
 void new_dynarec_init() {}
 void new_dyna_start() {}
 void new_dynarec_cleanup() {}
 void new_dynarec_clear_full() {}
+int new_dynarec_save_cache(const char *fname) { return -1; }
+int new_dynarec_load_cache(const char *fname) { return -1; }
 void invalidate_all_pages() {}
 void invalidate_block(unsigned int block) {}
 void new_dyna_pcsx_mem_init(void) {}
@@ -491,3 +498,162 @@ ok:
 }
 
 #endif
+
+#ifdef DRC_PROFILE
+
+#include <stdlib.h>
+#include "../debug.h"
+
+#define PROF_BLOCKS	0x10000
+#define PROF_TOP	64
+#define PROF_TOP_PAGES	32
+#define PROF_DIS_MAX	24
+
+static struct drc_prof_block prof_blocks[PROF_BLOCKS];
+static struct drc_prof_block prof_other = { ~0u, };
+static struct drc_prof_block *prof_last;
+static u32 prof_last_cycle;
+static u32 prof_compiles[4096], prof_invals[4096];
+
+// called at translation time, the returned pointer gets baked
+// into the code, so entries are never moved or freed
+struct drc_prof_block *drc_prof_get(u32 vaddr, u32 len)
+{
+	u32 h = ((vaddr >> 2) * 0x9e3779b1) >> 16;
+	int i;
+
+	for (i = 0; i < 64; i++, h = (h + 1) & (PROF_BLOCKS - 1)) {
+		if (prof_blocks[h].len == 0) {
+			prof_blocks[h].vaddr = vaddr;
+			prof_blocks[h].len = len;
+			return &prof_blocks[h];
+		}
+		if (prof_blocks[h].vaddr == vaddr) {
+			if (len > prof_blocks[h].len)
+				prof_blocks[h].len = len;
+			return &prof_blocks[h];
+		}
+	}
+
+	return &prof_other;
+}
+
+// called from block entry points, cc is the cycle register (cycles - next_interupt)
+void drc_prof_enter(struct drc_prof_block *b, int cc)
+{
+	u32 cycle = next_interupt + cc;
+
+	if (prof_last != NULL)
+		prof_last->cycles += cycle - prof_last_cycle;
+	b->count++;
+	prof_last = b;
+	prof_last_cycle = cycle;
+}
+
+static void drc_prof_leave(void)
+{
+	if (prof_last != NULL)
+		prof_last->cycles += psxRegs.cycle - prof_last_cycle;
+	prof_last = NULL;
+}
+
+void drc_prof_page(u32 page, int invalidate)
+{
+	page &= 4095;
+	if (invalidate)
+		prof_invals[page]++;
+	else
+		prof_compiles[page]++;
+}
+
+static int prof_cmp_block(const void *p1, const void *p2)
+{
+	const struct drc_prof_block *b1 = *(const struct drc_prof_block **)p1;
+	const struct drc_prof_block *b2 = *(const struct drc_prof_block **)p2;
+
+	if (b1->cycles != b2->cycles)
+		return b1->cycles < b2->cycles ? 1 : -1;
+	return b1->count < b2->count ? 1 : (b1->count > b2->count ? -1 : 0);
+}
+
+static int prof_cmp_page(const void *p1, const void *p2)
+{
+	u32 pg1 = *(const u32 *)p1, pg2 = *(const u32 *)p2;
+	u32 c1 = prof_invals[pg1] + prof_compiles[pg1];
+	u32 c2 = prof_invals[pg2] + prof_compiles[pg2];
+
+	return c1 < c2 ? 1 : (c1 > c2 ? -1 : 0);
+}
+
+static void drc_prof_report(const char *fname)
+{
+	static struct drc_prof_block *sorted[PROF_BLOCKS + 1];
+	static u32 pages[4096];
+	u64 total = 0;
+	int i, j, n = 0;
+	FILE *f;
+
+	f = fopen(fname, "w");
+	if (f == NULL) {
+		perror(fname);
+		return;
+	}
+
+	for (i = 0; i < PROF_BLOCKS; i++) {
+		if (prof_blocks[i].count == 0)
+			continue;
+		sorted[n++] = &prof_blocks[i];
+		total += prof_blocks[i].cycles;
+	}
+	if (prof_other.count != 0) {
+		sorted[n++] = &prof_other;
+		total += prof_other.cycles;
+	}
+	qsort(sorted, n, sizeof(sorted[0]), prof_cmp_block);
+
+	fprintf(f, "%d entry points executed, %llu cycles\n\n", n,
+		(unsigned long long)total);
+	fprintf(f, "   vaddr      count        cycles      %%  cyc/exec\n");
+	for (i = 0; i < n && i < PROF_TOP; i++) {
+		struct drc_prof_block *b = sorted[i];
+		u32 *code;
+
+		fprintf(f, "%08x %10u %13llu %6.2f %9.1f\n", b->vaddr, b->count,
+			(unsigned long long)b->cycles,
+			total ? b->cycles * 100.0 / total : 0.0,
+			(double)b->cycles / b->count);
+		if (b == &prof_other)
+			continue;
+		for (j = 0; j < b->len && j < PROF_DIS_MAX; j++) {
+			code = (u32 *)PSXM(b->vaddr + j * 4);
+			if (code == NULL)
+				break;
+			fprintf(f, "    %s\n", disR3000AF(SWAP32(*code), b->vaddr + j * 4));
+		}
+		if (j < b->len)
+			fprintf(f, "    ...\n");
+	}
+
+	for (i = 0; i < 4096; i++)
+		pages[i] = i;
+	qsort(pages, 4096, sizeof(pages[0]), prof_cmp_page);
+
+	fprintf(f, "\npage                compiles  invalidations\n");
+	for (i = 0; i < PROF_TOP_PAGES; i++) {
+		u32 pg = pages[i];
+		if (prof_compiles[pg] + prof_invals[pg] == 0)
+			break;
+		// same page numbering as new_dynarec's get_page(),
+		// everything outside RAM shares hashed pages from 2048
+		if (pg < 2048)
+			fprintf(f, "%08x-%08x", 0x80000000 | (pg << 12), 0x80000000 | (pg << 12) | 0xfff);
+		else
+			fprintf(f, "non-RAM #%-8u", pg - 2048);
+		fprintf(f, " %9u %14u\n", prof_compiles[pg], prof_invals[pg]);
+	}
+
+	fclose(f);
+	printf("drc profile written to %s\n", fname);
+}
+
+#endif
@@ -55,5 +55,19 @@ extern int pending_exception;
 void pcsx_mtc0(u32 reg);
 void pcsx_mtc0_ds(u32 reg);
 
+#ifdef DRC_PROFILE
+/* per entry point stats, see emu_if.c */
+struct drc_prof_block {
+	u32 vaddr;
+	u32 len;	/* instructions from vaddr to the end of the block */
+	u32 count;
+	u64 cycles;
+};
+
+struct drc_prof_block *drc_prof_get(u32 vaddr, u32 len);
+void drc_prof_enter(struct drc_prof_block *b, int cc);
+void drc_prof_page(u32 page, int invalidate);
+#endif
+
 /* misc */
 extern void (*psxHLEt[])();
@@ -599,6 +599,8 @@ cc_interrupt:
 	tst	r4, r4
 	bne	.E4
 .E1:
+	mov	r0, r10
+	bl	new_dynarec_sample
 	bl	gen_interupt
 	mov	lr, r10
 	ldr	r10, [fp, #cycle-dynarec_local]
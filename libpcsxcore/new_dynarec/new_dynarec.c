@@ -129,6 +129,16 @@ struct ll_entry
   static u_int sp_in_mirror;
   u_int stop_after_jal;
   extern u_char restore_candidate[512];
+  // translation cache is expired in 8 slices, hot ones can be kept a lap
+  u_int slice_hits[8];
+  u_char slice_laps[8];
+  u_char slice_kept;
+  u_char expired_code[RAM_SIZE>>5];
+  struct {
+    u_int laps,blocks,retranslated,kept;
+  } cache_stats;
+  // Config.CycleModel the blocks in the cache were built with, -1 if none
+  int new_dynarec_cycle_model=-1;
   extern int cycle_count;
 
   /* registers that may be allocated */
@@ -341,6 +351,8 @@ static u_int get_vpage(u_int vaddr)
   return vpage;
 }
 
+static void mark_code(int addr);
+
 // Get address from virtual address
 // This is called from the recompiled JR/JALR instructions
 void *get_addr(u_int vaddr)
@@ -372,6 +384,7 @@ void *get_addr(u_int vaddr)
         //printf("restore candidate: %x (%d) d=%d\n",vaddr,page,invalid_code[vaddr>>12]);
         invalid_code[vaddr>>12]=0;
         memory_map[vaddr>>12]|=0x40000000;
+        mark_code((int)head->addr);
         if(vpage<2048) {
 #ifndef DISABLE_TLB
           if(tlb_LUT_r[vaddr>>12]) {
@@ -464,6 +477,7 @@ void *get_addr_32(u_int vaddr,u_int flags)
         //printf("restore candidate: %x (%d) d=%d\n",vaddr,page,invalid_code[vaddr>>12]);
         invalid_code[vaddr>>12]=0;
         memory_map[vaddr>>12]|=0x40000000;
+        mark_code((int)head->addr);
         if(vpage<2048) {
 #ifndef DISABLE_TLB
           if(tlb_LUT_r[vaddr>>12]) {
@@ -995,6 +1009,18 @@ void ll_add_32(struct ll_entry **head,int vaddr,u_int reg32,void *addr)
 #endif
 }
 
+// Tell the memory code about RAM holding a block that is being
+// reused without recompiling, so writes to it get passed back to us
+static void mark_code(int addr)
+{
+#ifdef PCSX
+  u_int start,end;
+  get_bounds(addr,&start,&end);
+  if(start-(u_int)rdram<RAM_SIZE)
+    psxMemMarkCode(start-(u_int)rdram+0x80000000,end-start);
+#endif
+}
+
 // Check if an address is already compiled
 // but don't return addresses which are about to expire from the cache
 void *check_addr(u_int vaddr)
@@ -1055,12 +1081,28 @@ void remove_hash(int vaddr)
   }
 }
 
+// Translation cache expiry works on 1/8 of the cache at a time.
+// Entry points and stubs follow the code of a block, so a block started
+// near the end of a slice can have them up to MAX_OUTPUT_BLOCK_SIZE into
+// the next one, and those are expired together with the slice.
+// Next to a slice that is kept for another lap (see keep_slice()),
+// link sites in the kept slice must stay tracked, and blocks at its end
+// die with the slice after it, as their tail may be in there.
+static int expire_next=1,expire_prev=0;
+
+static int expire_match(u_int a,u_int base,int shift)
+{
+  if((a>>shift)==(base>>shift)) return 1;
+  if(expire_next&&((a-MAX_OUTPUT_BLOCK_SIZE)>>shift)==(base>>shift)) return 1;
+  if(expire_prev&&((a+MAX_OUTPUT_BLOCK_SIZE)>>shift)==(base>>shift)) return 1;
+  return 0;
+}
+
 void ll_remove_matching_addrs(struct ll_entry **head,int addr,int shift)
 {
   struct ll_entry *next;
   while(*head) {
-    if(((u_int)((*head)->addr)>>shift)==(addr>>shift) || 
-       ((u_int)((*head)->addr-MAX_OUTPUT_BLOCK_SIZE)>>shift)==(addr>>shift))
+    if(expire_match((u_int)(*head)->addr,addr,shift))
     {
       inv_debug("EXP: Remove pointer to %x (%x)\n",(int)(*head)->addr,(*head)->vaddr);
       remove_hash((*head)->vaddr);
@@ -1096,8 +1138,7 @@ void ll_kill_pointers(struct ll_entry *head,int addr,int shift)
   while(head) {
     int ptr=get_pointer(head->addr);
     inv_debug("EXP: Lookup pointer to %x at %x (%x)\n",(int)ptr,(int)head->addr,head->vaddr);
-    if(((ptr>>shift)==(addr>>shift)) ||
-       (((ptr-MAX_OUTPUT_BLOCK_SIZE)>>shift)==(addr>>shift)))
+    if(expire_match(ptr,addr,shift))
     {
       inv_debug("EXP: Kill pointer at %x (%x)\n",(int)head->addr,head->vaddr);
       u_int host_addr=(u_int)kill_pointer(head->addr);
@@ -1109,6 +1150,18 @@ void ll_kill_pointers(struct ll_entry *head,int addr,int shift)
   }
 }
 
+// Remember which code is being expired, to count how much of it
+// has to be translated again
+static void mark_expired(struct ll_entry *head,int addr,int shift)
+{
+  for(;head!=NULL;head=head->next) {
+    if(expire_match((u_int)head->addr,addr,shift)) {
+      u_int w=(head->vaddr&(RAM_SIZE-1))>>2;
+      expired_code[w>>3]|=1<<(w&7);
+    }
+  }
+}
+
 // This is called when we write to a compiled block (see do_invstub)
 void invalidate_page(u_int page)
 {
@@ -1141,6 +1194,9 @@ void invalidate_block(u_int block)
   u_int page=get_page(block<<12);
   u_int vpage=get_vpage(block<<12);
   inv_debug("INVALIDATE: %x (%d)\n",block<<12,page);
+#ifdef DRC_PROFILE
+  drc_prof_page(page,1);
+#endif
   //inv_debug("invalid_code[block]=%d\n",invalid_code[block]);
   u_int first,last;
   first=last=page;
@@ -1294,6 +1350,7 @@ void clean_blocks(u_int page)
               if(page<2048&&tlb_LUT_r[head->vaddr>>12]) ppage=(tlb_LUT_r[head->vaddr>>12]^0x80000000)>>12;
 #endif
               inv_debug("INV: Restored %x (%x/%x)\n",head->vaddr, (int)head->addr, (int)clean_addr);
+              mark_code((int)head->addr);
               //printf("page=%x, addr=%x\n",page,head->vaddr);
               //assert(head->vaddr>>12==(page|0x80000));
               ll_add_32(jump_in+ppage,head->vaddr,head->reg32,clean_addr);
@@ -4829,11 +4886,21 @@ void ds_assemble_entry(int i)
   emit_jmp(0);
 }
 
+// backward branch closing a polling loop within the block,
+// register contents aren't known here so neither are load bases
+// from outside the loop
+static int idle_loop(int i)
+{
+  int t=(ba[i]-start)>>2;
+  if(ba[i]<start||t>i) return 0;
+  return psxTestIdleLoop(&source[t],i-t+2,NULL);
+}
+
 void do_cc(int i,signed char i_regmap[],int *adj,int addr,int taken,int invert)
 {
   int count;
   int jaddr;
-  int idle=0;
+  int idle=0,poll=0;
   if(itype[i]==RJUMP)
   {
     *adj=0;
@@ -4850,7 +4917,7 @@ void do_cc(int i,signed char i_regmap[],int *adj,int addr,int taken,int invert)
     *adj=0;
   }
   count=ccadj[i];
-  if(taken==TAKEN && i==(ba[i]-start)>>2 && source[i+1]==0) {
+  if(taken==TAKEN && i==(ba[i]-start)>>2 && source[i+1]==0 && !Config.NoIdleSkip) {
     // Idle loop
     if(count&1) emit_addimm_and_set_flags(2*(count+2),HOST_CCREG);
     idle=(int)out;
@@ -4859,6 +4926,14 @@ void do_cc(int i,signed char i_regmap[],int *adj,int addr,int taken,int invert)
     jaddr=(int)out;
     emit_jmp(0);
   }
+  else if(taken==TAKEN && idle_loop(i)) {
+    // Polling loop, nothing changes before the next event so skip to it.
+    // Unlike above, the loop body has to run again after the event.
+    emit_andimm(HOST_CCREG,3,HOST_CCREG);
+    jaddr=(int)out;
+    emit_jmp(0);
+    poll=1;
+  }
   else if(*adj==0||invert) {
     emit_addimm_and_set_flags(CLOCK_DIVIDER*(count+2),HOST_CCREG);
     jaddr=(int)out;
@@ -4870,7 +4945,7 @@ void do_cc(int i,signed char i_regmap[],int *adj,int addr,int taken,int invert)
     jaddr=(int)out;
     emit_jns(0);
   }
-  add_stub(CC_STUB,jaddr,idle?idle:(int)out,(*adj==0||invert||idle)?0:(count+2),i,addr,taken,0);
+  add_stub(CC_STUB,jaddr,idle?idle:(int)out,(*adj==0||invert||idle||poll)?0:(count+2),i,addr,taken,0);
 }
 
 void do_ccstub(int n)
@@ -7780,7 +7855,11 @@ void new_dynarec_clear_full()
   memset(restore_candidate,0,sizeof(restore_candidate));
   memset(shadow,0,sizeof(shadow));
   copy=shadow;
-  expirep=16384; // Expiry pointer, +2 blocks
+  expirep=((((int)out-BASE_ADDR)>>(TARGET_SIZE_2-16))+16384)&65535; // Expiry pointer, +2 blocks
+  slice_kept=0;
+  memset(slice_laps,0,sizeof(slice_laps));
+  memset(expired_code,0,sizeof(expired_code));
+  new_dynarec_cycle_model=-1;
   pending_exception=0;
   literalcount=0;
   stop_after_jal=0;
@@ -7874,6 +7953,227 @@ void new_dynarec_cleanup()
   #endif
 }
 
+// Persistent translation cache.
+// Generated code has host addresses (helpers, tables, RAM, the shadow
+// copies) baked into it, so instead of relocating it the cache is only
+// accepted when it was written by the same executable, with all of the
+// runtime placed addresses the same as well.
+// Only dirty entry points are kept, so every block gets its source
+// compared to the shadow copy before it's used, like after a state load.
+#define CACHE_MAGIC   0x4352444e // "NDRC"
+#define CACHE_VERSION 3
+#define CACHE_LAYOUT  16
+
+struct cache_header
+{
+  u_int magic;
+  u_int version;
+  u_int layout[CACHE_LAYOUT];
+  u_int code_size;
+  u_int out;
+  u_int expirep;
+  u_int slice_kept;
+  u_int copy;
+  u_int entries;
+};
+
+struct cache_entry
+{
+  u_int vpage;
+  u_int vaddr;
+  u_int reg32;
+  u_int addr;
+};
+
+// FNV-1a over the whole executable image, as any code linked into it
+// (gte handlers, HLE tables, memory handlers) may be called from blocks
+static u_int exe_hash()
+{
+  static u_int hash;
+  u_char buf[4096];
+  size_t n,i;
+  FILE *f;
+  if(hash) return hash;
+  f=fopen("/proc/self/exe","rb");
+  if(f==NULL) return 0;
+  hash=2166136261u;
+  while((n=fread(buf,1,sizeof(buf),f))>0)
+    for(i=0;i<n;i++) hash=(hash^buf[i])*16777619u;
+  if(ferror(f)) hash=0;
+  fclose(f);
+  return hash;
+}
+
+static int cache_layout(u_int *l)
+{
+  memset(l,0,CACHE_LAYOUT*sizeof(l[0]));
+  l[0]=exe_hash();
+  if(l[0]==0) return -1;
+  l[0]+=Config.CycleModel; // blocks are timed differently
+  l[1]=BASE_ADDR;
+  l[2]=TARGET_SIZE_2;
+  l[3]=(u_int)rdram;
+  l[4]=(u_int)shadow;
+  l[5]=(u_int)&dynarec_local;
+  l[6]=(u_int)invalid_code;
+  l[7]=(u_int)hash_table;
+  l[8]=(u_int)mini_ht;
+  l[9]=(u_int)jump_vaddr;
+  l[10]=(u_int)verify_code;
+  l[11]=(u_int)cc_interrupt;
+  l[12]=(u_int)new_dyna_leave;
+  l[13]=(u_int)readmem;
+  l[14]=(u_int)gte_handlers;
+  l[15]=(u_int)psxH_ptr;
+  return 0;
+}
+
+int new_dynarec_save_cache(const char *fname)
+{
+  struct cache_header h;
+  struct cache_entry e;
+  struct ll_entry *head;
+  u_int code_end=(u_int)out;
+  FILE *f;
+  int n;
+
+  // unlink blocks from each other, links don't check the source
+  invalidate_all_pages();
+
+  memset(&h,0,sizeof(h));
+  for(n=0;n<4096;n++) {
+    for(head=jump_dirty[n];head!=NULL;head=head->next) {
+      if(!verify_dirty((int)head->addr)) continue;
+      if((u_int)head->addr>=(u_int)out) code_end=BASE_ADDR+(1<<TARGET_SIZE_2); // wrapped
+      h.entries++;
+    }
+  }
+  if(h.entries==0) return -1;
+  if(cache_layout(h.layout)<0) return -1;
+
+  f=fopen(fname,"wb");
+  if(f==NULL) return -1;
+
+  h.magic=CACHE_MAGIC;
+  h.version=CACHE_VERSION;
+  h.code_size=code_end-BASE_ADDR;
+  h.out=(u_int)out-BASE_ADDR;
+  h.expirep=expirep;
+  h.slice_kept=slice_kept;
+  h.copy=(u_char *)copy-(u_char *)shadow;
+  fwrite(&h,sizeof(h),1,f);
+  fwrite((void *)BASE_ADDR,1,h.code_size,f);
+  fwrite(shadow,1,sizeof(shadow),f);
+  for(n=0;n<4096;n++) {
+    for(head=jump_dirty[n];head!=NULL;head=head->next) {
+      if(!verify_dirty((int)head->addr)) continue;
+      e.vpage=n;
+      e.vaddr=head->vaddr;
+      e.reg32=head->reg32;
+      e.addr=(u_int)head->addr-BASE_ADDR;
+      fwrite(&e,sizeof(e),1,f);
+    }
+  }
+  n=ferror(f);
+  fclose(f);
+  if(n) {
+    remove(fname);
+    return -1;
+  }
+  printf("drc cache: saved %u blocks, %u KiB\n",h.entries,h.code_size>>10);
+  return 0;
+}
+
+int new_dynarec_load_cache(const char *fname)
+{
+  struct cache_header h;
+  struct cache_entry e;
+  u_int layout[CACHE_LAYOUT];
+  FILE *f;
+  u_int n;
+
+  if(cache_layout(layout)<0) return -1;
+  f=fopen(fname,"rb");
+  if(f==NULL) return -1;
+
+  if(fread(&h,sizeof(h),1,f)!=1||h.magic!=CACHE_MAGIC||h.version!=CACHE_VERSION
+     ||memcmp(h.layout,layout,sizeof(layout))!=0
+     ||h.code_size>(1<<TARGET_SIZE_2)||h.out>h.code_size||h.copy>sizeof(shadow))
+  {
+    printf("drc cache: %s is stale, ignored\n",fname);
+    fclose(f);
+    return -1;
+  }
+
+  new_dynarec_clear_full();
+  if(fread((void *)BASE_ADDR,1,h.code_size,f)!=h.code_size) goto fail;
+  if(fread(shadow,1,sizeof(shadow),f)!=sizeof(shadow)) goto fail;
+  for(n=0;n<h.entries;n++) {
+    if(fread(&e,sizeof(e),1,f)!=1) goto fail;
+    if(e.vpage>=4096||e.addr>=h.code_size) goto fail;
+    ll_add_32(jump_dirty+e.vpage,e.vaddr,e.reg32,(void *)(BASE_ADDR+e.addr));
+  }
+  fclose(f);
+
+  out=(u_char *)BASE_ADDR+h.out;
+  expirep=h.expirep;
+  slice_kept=h.slice_kept;
+  copy=shadow+h.copy;
+  new_dynarec_cycle_model=Config.CycleModel; // part of the layout
+  #ifdef __arm__
+  __clear_cache((void *)BASE_ADDR,(void *)BASE_ADDR+(1<<TARGET_SIZE_2));
+  #endif
+  printf("drc cache: loaded %u blocks, %u KiB\n",h.entries,h.code_size>>10);
+  return 0;
+
+fail:
+  printf("drc cache: %s is truncated\n",fname);
+  fclose(f);
+  new_dynarec_clear_full();
+  return -1;
+}
+
+// Called from cc_interrupt with the return address, which is
+// in the block that ran out of cycles, to find the hot slices.
+void new_dynarec_sample(u_int addr)
+{
+  addr-=BASE_ADDR;
+  if(addr<(1<<TARGET_SIZE_2))
+    slice_hits[addr>>(TARGET_SIZE_2-3)]++;
+}
+
+// Decide if a slice should survive the coming expiry pass.
+// Only one slice is kept at a time, and not for more than 3 laps in a
+// row, so everything is eventually recycled.
+static void keep_slice(int s)
+{
+  u_int total=0;
+  int n;
+  for(n=0;n<8;n++) total+=slice_hits[n];
+  if(slice_kept==0&&slice_laps[s]<3&&slice_hits[s]>=64&&slice_hits[s]>total/4) {
+    inv_debug("EXP: keep slice %d (%d/%d)\n",s,slice_hits[s],total);
+    slice_kept=1<<s;
+    slice_laps[s]++;
+    slice_hits[s]>>=1;
+    cache_stats.kept++;
+  }
+  else {
+    slice_laps[s]=0;
+    slice_hits[s]=0;
+  }
+}
+
+// Code output wrapped around to the start of the cache
+static void cache_lap()
+{
+  cache_stats.laps++;
+#ifdef DRC_PROFILE
+  printf("drc: cache lap %u: %u blocks, %u translated again after expiry, %u slices kept\n",
+    cache_stats.laps,cache_stats.blocks,cache_stats.retranslated,cache_stats.kept);
+#endif
+  cache_stats.blocks=cache_stats.retranslated=cache_stats.kept=0;
+}
+
 int new_recompile_block(int addr)
 {
 /*
@@ -7897,6 +8197,18 @@ int new_recompile_block(int addr)
   //rlist();
   start = (u_int)addr&~3;
   //assert(((u_int)addr&1)==0);
+#ifdef DRC_PROFILE
+  drc_prof_page(get_page(start),0);
+#endif
+  cache_stats.blocks++;
+  if(new_dynarec_cycle_model<0) new_dynarec_cycle_model=Config.CycleModel;
+  if(get_page(start)<(RAM_SIZE>>12)) {
+    u_int w=(start&(RAM_SIZE-1))>>2;
+    if(expired_code[w>>3]&(1<<(w&7))) {
+      expired_code[w>>3]&=~(1<<(w&7));
+      cache_stats.retranslated++;
+    }
+  }
 #ifdef PCSX
   if(!sp_in_mirror&&(signed int)(psxRegs.GPR.n.sp&0xffe00000)>0x80200000&&
      0x10000<=psxRegs.GPR.n.sp&&(psxRegs.GPR.n.sp&~0xe0e00000)<RAM_SIZE) {
@@ -8964,8 +9276,10 @@ int new_recompile_block(int addr)
               if(rs2[i]) alloc_reg64(&current,i,rs2[i]);
             }
             if((rs1[i]&&(rs1[i]==rt1[i+1]||rs1[i]==rt2[i+1]))||
-               (rs2[i]&&(rs2[i]==rt1[i+1]||rs2[i]==rt2[i+1]))) {
-              // The delay slot overwrites one of our conditions.
+               (rs2[i]&&(rs2[i]==rt1[i+1]||rs2[i]==rt2[i+1]))||
+               idle_loop(i)) {
+              // The delay slot overwrites one of our conditions,
+              // or we need the taken path for idle loop skipping.
               // Allocate the branch condition registers instead.
               current.isconst=0;
               current.wasconst=0;
@@ -8994,8 +9308,9 @@ int new_recompile_block(int addr)
             {
               alloc_reg64(&current,i,rs1[i]);
             }
-            if(rs1[i]&&(rs1[i]==rt1[i+1]||rs1[i]==rt2[i+1])) {
-              // The delay slot overwrites one of our conditions.
+            if((rs1[i]&&(rs1[i]==rt1[i+1]||rs1[i]==rt2[i+1]))||idle_loop(i)) {
+              // The delay slot overwrites one of our conditions,
+              // or we need the taken path for idle loop skipping.
               // Allocate the branch condition registers instead.
               current.isconst=0;
               current.wasconst=0;
@@ -9071,7 +9386,8 @@ int new_recompile_block(int addr)
               //current.is32|=1LL<<rt1[i];
             }
             if((rs1[i]&&(rs1[i]==rt1[i+1]||rs1[i]==rt2[i+1])) // The delay slot overwrites the branch condition.
-               ||(rt1[i]==31&&(rs1[i+1]==31||rs2[i+1]==31||rt1[i+1]==31||rt2[i+1]==31))) { // DS touches $ra
+               ||(rt1[i]==31&&(rs1[i+1]==31||rs2[i+1]==31||rt1[i+1]==31||rt2[i+1]==31)) // DS touches $ra
+               ||idle_loop(i)) { // need the taken path for idle loop skipping
               // Allocate the branch condition registers instead.
               current.isconst=0;
               current.wasconst=0;
@@ -9584,6 +9900,8 @@ int new_recompile_block(int addr)
     {
       cc++;
     }
+    if(Config.CycleModel)
+      cc+=(psxInstrCycles(source[i])+CLOCK_DIVIDER/2)/CLOCK_DIVIDER;
 
     flush_dirty_uppers(&current);
     if(!is_ds[i]) {
@@ -11086,7 +11404,22 @@ int new_recompile_block(int addr)
   
   // If we're within 256K of the end of the buffer,
   // start over from the beginning. (Is 256K enough?)
-  if((int)out>BASE_ADDR+(1<<TARGET_SIZE_2)-MAX_OUTPUT_BLOCK_SIZE) out=(u_char *)BASE_ADDR;
+  if((int)out>BASE_ADDR+(1<<TARGET_SIZE_2)-MAX_OUTPUT_BLOCK_SIZE) {
+    out=(u_char *)BASE_ADDR;
+    cache_lap();
+  }
+  // Same for a slice that was kept, continue past it
+  {
+    int s=(((int)out+MAX_OUTPUT_BLOCK_SIZE-BASE_ADDR)>>(TARGET_SIZE_2-3))&7;
+    if(slice_kept&(1<<s)) {
+      slice_kept&=~(1<<s);
+      out=(u_char *)BASE_ADDR+((s+1)<<(TARGET_SIZE_2-3));
+      if(s==7) {
+        out=(u_char *)BASE_ADDR;
+        cache_lap();
+      }
+    }
+  }
   
   // Trap writes to any of the pages we compiled
   for(i=start>>12;i<=(start+slen*4)>>12;i++) {
@@ -11107,20 +11440,34 @@ int new_recompile_block(int addr)
   if(get_page(start)<(RAM_SIZE>>12))
     for(i=start>>12;i<=(start+slen*4)>>12;i++)
       invalid_code[((u_int)0x80000000>>12)|i]=0;
+  psxMemMarkCode(start,slen*4);
 #endif
   
   /* Pass 10 - Free memory by expiring oldest blocks */
   
   int end=((((int)out-BASE_ADDR)>>(TARGET_SIZE_2-16))+16384)&65535;
-  while(expirep!=end)
+  // expirep runs a slice further ahead while skipping a kept one
+  while(expirep!=end&&((end-expirep)&65535)<32768)
   {
     int shift=TARGET_SIZE_2-3; // Divide into 8 blocks
     int base=BASE_ADDR+((expirep>>13)<<shift); // Base address of this block
     inv_debug("EXP: Phase %d\n",expirep);
+    if((expirep&8191)==0) {
+      int s=expirep>>13;
+      slice_kept&=~(1<<((s-2)&7)); // lap done for the one we skipped
+      if(slice_kept&(1<<s)) {
+        expirep=(expirep+8192)&65535;
+        continue;
+      }
+      keep_slice((s+1)&7);
+    }
+    expire_next=((expirep>>11)&3)!=3||!(slice_kept&(1<<(((expirep>>13)+1)&7)));
+    expire_prev=(slice_kept&(1<<(((expirep>>13)-1)&7)))!=0;
     switch((expirep>>11)&3)
     {
       case 0:
         // Clear jump_in and jump_dirty
+        mark_expired(jump_in[expirep&2047],base,shift);
         ll_remove_matching_addrs(jump_in+(expirep&2047),base,shift);
         ll_remove_matching_addrs(jump_dirty+(expirep&2047),base,shift);
         ll_remove_matching_addrs(jump_in+2048+(expirep&2047),base,shift);
@@ -11135,13 +11482,11 @@ int new_recompile_block(int addr)
         // Clear hash table
         for(i=0;i<32;i++) {
           int *ht_bin=hash_table[((expirep&2047)<<5)+i];
-          if((ht_bin[3]>>shift)==(base>>shift) ||
-             ((ht_bin[3]-MAX_OUTPUT_BLOCK_SIZE)>>shift)==(base>>shift)) {
+          if(expire_match(ht_bin[3],base,shift)) {
             inv_debug("EXP: Remove hash %x -> %x\n",ht_bin[2],ht_bin[3]);
             ht_bin[2]=ht_bin[3]=-1;
           }
-          if((ht_bin[1]>>shift)==(base>>shift) ||
-             ((ht_bin[1]-MAX_OUTPUT_BLOCK_SIZE)>>shift)==(base>>shift)) {
+          if(expire_match(ht_bin[1],base,shift)) {
             inv_debug("EXP: Remove hash %x -> %x\n",ht_bin[0],ht_bin[1]);
             ht_bin[0]=ht_bin[2];
             ht_bin[1]=ht_bin[3];
@@ -11161,6 +11506,8 @@ int new_recompile_block(int addr)
     }
     expirep=(expirep+1)&65535;
   }
+  expire_next=1;
+  expire_prev=0;
   return 0;
 }
 
@@ -3,10 +3,13 @@
 extern int pcaddr;
 extern int pending_exception;
 extern int stop;
+extern int new_dynarec_cycle_model;
 
 void new_dynarec_init();
 void new_dynarec_cleanup();
 void new_dynarec_clear_full();
+int new_dynarec_save_cache(const char *fname);
+int new_dynarec_load_cache(const char *fname);
 void new_dyna_start();
 
 void invalidate_all_pages();
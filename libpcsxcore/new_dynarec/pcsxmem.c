@@ -374,6 +374,44 @@ void new_dyna_pcsx_mem_init(void)
 	nd_pcsx_io.tab_write32 = io_write32;
 }
 
+/*
+ * For the recompiler to call the handler directly when the address is
+ * known at compile time. Returns the table slot rather than the function
+ * because GPU/SPU ones change with the plugins. Follows ari_read_io and
+ * ari_write_io, 8bit writes always update psxH too.
+ */
+int new_dyna_pcsx_io_lookup(int size, int is_write, unsigned int addr,
+	const void ***slot)
+{
+	const void **tab;
+	u32 a;
+
+	*slot = NULL;
+	if ((addr & 0xfffff000) != 0x1f801000)
+		return PCSX_IO_GENERIC;
+
+	a = addr & 0xfff & ~(size / 8 - 1);
+	if (a >= 0xc00 && a < 0xe00 && size == 16) {
+		*slot = (const void **)(is_write ? &nd_pcsx_io.spu_writef : &nd_pcsx_io.spu_readf);
+		return PCSX_IO_SPU;
+	}
+	if (a >= 0xc00 && a < 0xe00 && size == 32 && is_write)
+		return PCSX_IO_GENERIC;
+	if (a >= 0x880)
+		return PCSX_IO_PLAIN;
+
+	switch (size) {
+	case 8:  tab = is_write ? io_write8  : io_read8;  a = IOADR8(a);  break;
+	case 16: tab = is_write ? io_write16 : io_read16; a = IOADR16(a); break;
+	default: tab = is_write ? io_write32 : io_read32; a = IOADR32(a); break;
+	}
+	if (tab[a] == NULL)
+		return PCSX_IO_PLAIN;
+
+	*slot = &tab[a];
+	return PCSX_IO_HANDLER;
+}
+
 void new_dyna_pcsx_mem_reset(void)
 {
 	// plugins might change so update the pointers
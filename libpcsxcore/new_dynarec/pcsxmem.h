@@ -1,3 +1,14 @@
 
 void new_dyna_pcsx_mem_init(void);
 void new_dyna_pcsx_mem_reset(void);
+
+/* what a load/store to a constant io address ends up doing */
+enum pcsx_io_kind {
+	PCSX_IO_PLAIN,		/* just psxH access */
+	PCSX_IO_HANDLER,	/* call *slot(value), returns the read value */
+	PCSX_IO_SPU,		/* call *slot(address[, value]) */
+	PCSX_IO_GENERIC,	/* needs ari_*_io */
+};
+
+int new_dyna_pcsx_io_lookup(int size, int is_write, unsigned int addr,
+	const void ***slot);
@@ -124,4 +124,116 @@ static int pcsx_direct_write(int type, u_int addr, int rs, int rt, signed char *
   return 0;
 }
 
+// Constant io addresses: plain registers are accessed in psxH directly,
+// others call the device handler without going through ari_*_io.
+static int io_size(int type)
+{
+  if(type==LOADW_STUB||type==STOREW_STUB)
+    return 32;
+  if(type==LOADH_STUB||type==LOADHU_STUB||type==STOREH_STUB)
+    return 16;
+  return 8;
+}
+
+// cycle update as done by indirect_jump, then call the handler in *slot
+static void emit_io_call(const void **slot, signed char *regmap, int adj)
+{
+  int cc=get_reg(regmap,CCREG);
+  if(cc<0)
+    emit_loadreg(CCREG,2);
+  emit_addimm(cc<0?2:cc,CLOCK_DIVIDER*(adj+1),2);
+  emit_readword((int)&last_count,3);
+  emit_add(2,3,2);
+  emit_writeword(2,(int)&Count);
+  emit_movimm((u_int)slot,12);
+  emit_readword_indexed(0,12,12);
+  emit_callreg(12);
+}
+
+static int pcsx_direct_read_io(int type, u_int addr, int rt, signed char *regmap, int adj, u_int reglist)
+{
+  const void **slot;
+  int size=io_size(type);
+  int kind=new_dyna_pcsx_io_lookup(size,0,addr,&slot);
+
+  addr&=~(size/8-1);
+  if(kind==PCSX_IO_GENERIC)
+    return 0;
+  if(kind==PCSX_IO_PLAIN) {
+    assem_debug("pcsx_direct_read %08x io\n",addr);
+    if(rt<0)
+      return 1;
+    emit_movimm((u_int)&psxH[addr&0xffff],rt);
+    emit_ldr_type(type,0,rt,rt);
+    return 1;
+  }
+
+  assem_debug("pcsx_direct_read %08x io handler\n",addr);
+  save_regs(reglist);
+  if(kind==PCSX_IO_SPU)
+    emit_movimm(addr,0);
+  emit_io_call(slot,regmap,adj);
+  emit_writeword(0,(int)&readmem_dword);
+  restore_regs(reglist);
+  if(rt>=0) {
+    if(type==LOADB_STUB)
+      emit_movsbl((int)&readmem_dword,rt);
+    if(type==LOADBU_STUB)
+      emit_movzbl((int)&readmem_dword,rt);
+    if(type==LOADH_STUB)
+      emit_movswl((int)&readmem_dword,rt);
+    if(type==LOADHU_STUB)
+      emit_movzwl((int)&readmem_dword,rt);
+    if(type==LOADW_STUB)
+      emit_readword((int)&readmem_dword,rt);
+  }
+  return 1;
+}
+
+static int pcsx_direct_write_io(int type, u_int addr, int rt, signed char *regmap, int adj, u_int reglist)
+{
+  const void **slot;
+  int size=io_size(type);
+  int kind=new_dyna_pcsx_io_lookup(size,1,addr,&slot);
+  int cc;
+
+  addr&=~(size/8-1);
+  if(kind==PCSX_IO_GENERIC)
+    return 0;
+  if(kind==PCSX_IO_PLAIN||type==STOREB_STUB) {
+    assem_debug("pcsx_direct_write %08x io\n",addr);
+    emit_movimm((u_int)&psxH[addr&0xffff],HOST_TEMPREG);
+    emit_str_type(type,0,HOST_TEMPREG,rt);
+    if(kind==PCSX_IO_PLAIN)
+      return 1;
+  }
+
+  assem_debug("pcsx_direct_write %08x io handler\n",addr);
+  save_regs(reglist);
+  if(kind==PCSX_IO_SPU) {
+    if(rt!=1)
+      emit_mov(rt,1);
+    emit_movimm(addr,0);
+  }
+  else if(rt!=0)
+    emit_mov(rt,0);
+  if(type==STOREB_STUB)
+    emit_andimm(0,0xff,0);
+  if(type==STOREH_STUB)
+    emit_andimm(kind==PCSX_IO_SPU?1:0,0xffff,kind==PCSX_IO_SPU?1:0);
+  emit_io_call(slot,regmap,adj);
+  // handlers may schedule events
+  cc=get_reg(regmap,CCREG);
+  emit_readword((int)&Count,HOST_TEMPREG);
+  emit_readword((int)&next_interupt,2);
+  emit_addimm(HOST_TEMPREG,-CLOCK_DIVIDER*(adj+1),HOST_TEMPREG);
+  emit_writeword(2,(int)&last_count);
+  emit_sub(HOST_TEMPREG,2,cc<0?HOST_TEMPREG:cc);
+  if(cc<0) {
+    emit_storereg(CCREG,HOST_TEMPREG);
+  }
+  restore_regs(reglist);
+  return 1;
+}
+
 // vim:shiftwidth=2:expandtab
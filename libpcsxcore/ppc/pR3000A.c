@@ -3507,6 +3507,7 @@ static void recRecompile() {
 	iRet();
 
 done:;
+	psxMemMarkCode(pcold, pc - pcold);
 #if 0
 	MakeDataExecutable(ptr, ((u8*)ppcPtr)-((u8*)ptr));
 #else
@@ -30,51 +30,26 @@ typedef struct tagPPF_DATA {
 	struct tagPPF_DATA	*pNext;
 } PPF_DATA;
 
-typedef struct tagPPF_CACHE {
-	s32					addr;
-	struct tagPPF_DATA	*pNext;
-} PPF_CACHE;
+// flattened patch data: a bitmap of patched sectors with a rank table to
+// find a sector's entry in O(1), and per sector the patches merged into
+// runs of patched bytes, relative to the DATA_SIZE buffer cdrom.c passes
+typedef struct {
+	u16					pos;
+	u16					len;
+	u32					data;		// offset in ppfData
+} PPF_RUN;
 
-static PPF_CACHE		*ppfCache = NULL;
 static PPF_DATA			*ppfHead = NULL, *ppfLast = NULL;
 static int				iPPFNum = 0;
 
-// using a linked data list, and address array
-static void FillPPFCache() {
-	PPF_DATA		*p;
-	PPF_CACHE		*pc;
-	s32				lastaddr;
-
-	p = ppfHead;
-	lastaddr = -1;
-	iPPFNum = 0;
-
-	while (p != NULL) {
-		if (p->addr != lastaddr) iPPFNum++;
-		lastaddr = p->addr;
-		p = p->pNext;
-	}
-
-	if (iPPFNum <= 0) return;
-
-	pc = ppfCache = (PPF_CACHE *)malloc(iPPFNum * sizeof(PPF_CACHE));
+static u32				*ppfMap = NULL;		// bit per patched sector
+static u32				*ppfRank = NULL;	// set bits before each map word
+static int				ppfMapWords = 0;
+static u32				*ppfFirstRun = NULL;	// per patched sector, +1 entry
+static PPF_RUN			*ppfRuns = NULL;
+static unsigned char	*ppfData = NULL;
 
-	iPPFNum--;
-	p = ppfHead;
-	lastaddr = -1;
-
-	while (p != NULL) {
-		if (p->addr != lastaddr) {
-			pc->addr = p->addr;
-			pc->pNext = p;
-			pc++;
-		}
-		lastaddr = p->addr;
-		p = p->pNext;
-	}
-}
-
-void FreePPFCache() {
+static void FreePPFList() {
 	PPF_DATA *p = ppfHead;
 	void *pn;
 
@@ -85,49 +60,114 @@ void FreePPFCache() {
 	}
 	ppfHead = NULL;
 	ppfLast = NULL;
-
-	if (ppfCache != NULL) free(ppfCache);
-	ppfCache = NULL;
 }
 
-void CheckPPFCache(unsigned char *pB, unsigned char m, unsigned char s, unsigned char f) {
-	PPF_CACHE *pcstart, *pcend, *pcpos;
-	int addr = MSF2SECT(btoi(m), btoi(s), btoi(f)), pos, anz, start;
+// turn the sorted patch list into the flat lookup tables
+static void FillPPFCache() {
+	unsigned char	buf[DATA_SIZE], set[DATA_SIZE];
+	PPF_DATA		*p, *ps;
+	s32				addr, maxaddr = -1;
+	int				sectors = 0, runs = 0, bytes = 0;
+	int				i, pos, anz, start, sect, run, data;
+
+	// size everything first
+	for (p = ppfHead; p != NULL; p = p->pNext) {
+		if (p->addr < 0) continue;
+		if (p->addr != maxaddr) sectors++;
+		if (p->addr > maxaddr) maxaddr = p->addr;
+		runs++;		// merged runs never outnumber the patches
+		bytes += p->anz;
+	}
 
-	if (ppfCache == NULL) return;
+	if (sectors == 0) return;
+
+	ppfMapWords = maxaddr / 32 + 1;
+	ppfMap = calloc(ppfMapWords, sizeof(ppfMap[0]));
+	ppfRank = malloc(ppfMapWords * sizeof(ppfRank[0]));
+	ppfFirstRun = malloc((sectors + 1) * sizeof(ppfFirstRun[0]));
+	ppfRuns = malloc(runs * sizeof(ppfRuns[0]));
+	ppfData = malloc(bytes);
+	if (ppfMap == NULL || ppfRank == NULL || ppfFirstRun == NULL ||
+	    ppfRuns == NULL || ppfData == NULL) {
+		SysPrintf(_("PPF: out of memory\n"));
+		FreePPFCache();
+		return;
+	}
 
-	pcstart = ppfCache;
-	if (addr < pcstart->addr) return;
-	pcend = ppfCache + iPPFNum;
-	if (addr > pcend->addr) return;
+	sect = run = data = 0;
 
-	while (1) {
-		if (addr == pcend->addr) { pcpos = pcend; break; }
+	for (p = ppfHead; p != NULL; p = ps) {
+		addr = p->addr;
+		if (addr < 0) { ps = p->pNext; continue; }
 
-		pcpos = pcstart + (pcend - pcstart) / 2;
-		if (pcpos == pcstart) break;
-		if (addr < pcpos->addr) {
-			pcend = pcpos;
-			continue;
+		// apply this sector's patches in list order, as CheckPPFCache did
+		memset(set, 0, sizeof(set));
+		for (ps = p; ps != NULL && ps->addr == addr; ps = ps->pNext) {
+			pos = ps->pos - (CD_FRAMESIZE_RAW - DATA_SIZE);
+			anz = ps->anz;
+			if (pos < 0) { start = -pos; pos = 0; anz -= start; }
+			else start = 0;
+			if (anz <= 0) continue;
+			memcpy(buf + pos, (unsigned char *)(ps + 1) + start, anz);
+			memset(set + pos, 1, anz);
 		}
-		if (addr > pcpos->addr) {
-			pcstart = pcpos;
-			continue;
+
+		ppfMap[addr >> 5] |= 1u << (addr & 31);
+		ppfFirstRun[sect++] = run;
+
+		for (i = 0; i < DATA_SIZE; ) {
+			if (!set[i]) { i++; continue; }
+			ppfRuns[run].pos = i;
+			ppfRuns[run].data = data;
+			while (i < DATA_SIZE && set[i])
+				ppfData[data++] = buf[i++];
+			ppfRuns[run].len = i - ppfRuns[run].pos;
+			run++;
 		}
-		break;
 	}
+	ppfFirstRun[sect] = run;
 
-	if (addr == pcpos->addr) {
-		PPF_DATA *p = pcpos->pNext;
-		while (p != NULL && p->addr == addr) {
-			pos = p->pos - (CD_FRAMESIZE_RAW - DATA_SIZE);
-			anz = p->anz;
-			if (pos < 0) { start = -pos; pos = 0; anz -= start; }
-			else start = 0;
-			memcpy(pB + pos, (unsigned char *)(p + 1) + start, anz);
-			p = p->pNext;
-		}
+	for (i = 0, sect = 0; i < ppfMapWords; i++) {
+		ppfRank[i] = sect;
+		sect += __builtin_popcount(ppfMap[i]);
 	}
+
+	iPPFNum = sectors;
+	FreePPFList();
+}
+
+void FreePPFCache() {
+	FreePPFList();
+
+	free(ppfMap);
+	free(ppfRank);
+	free(ppfFirstRun);
+	free(ppfRuns);
+	free(ppfData);
+	ppfMap = ppfRank = ppfFirstRun = NULL;
+	ppfRuns = NULL;
+	ppfData = NULL;
+	ppfMapWords = 0;
+	iPPFNum = 0;
+}
+
+void CheckPPFCache(unsigned char *pB, unsigned char m, unsigned char s, unsigned char f) {
+	int addr = MSF2SECT(btoi(m), btoi(s), btoi(f));
+	u32 bits, bit;
+	PPF_RUN *r, *rend;
+	int idx;
+
+	if (ppfMap == NULL || addr < 0 || (addr >> 5) >= ppfMapWords) return;
+
+	bits = ppfMap[addr >> 5];
+	bit = 1u << (addr & 31);
+	if (!(bits & bit)) return;
+
+	idx = ppfRank[addr >> 5] + __builtin_popcount(bits & (bit - 1));
+	r = ppfRuns + ppfFirstRun[idx];
+	rend = ppfRuns + ppfFirstRun[idx + 1];
+	for (; r < rend; r++)
+		memcpy(pB + r->pos, ppfData + r->data, r->len);
 }
 
 static void AddToPPF(s32 ladr, s32 pos, s32 anz, unsigned char *ppfmem) {
@@ -326,7 +366,7 @@ void BuildPPFCache() {
 
 	fclose(ppffile);
 
-	FillPPFCache(); // build address array
+	FillPPFCache(); // build sector lookup
 
 	SysPrintf(_("Loaded PPF %d.0 patch: %s.\n"), method + 1, szPPF);
 }
@@ -177,6 +177,23 @@ char *biosC0n[256] = {
 #define Rv0 ((char *)PSXM(v0))
 #define Rsp ((char *)PSXM(sp))
 
+// host pointer for the guest range [addr, addr + len) if it is one
+// contiguous block there (no wrap at a RAM mirror or region end),
+// so the HLE string/memory calls can work on it in bulk
+static u8 *psxBios_range(u32 addr, u32 len) {
+	u8 *p, *e;
+
+	if (len == 0 || len > 0x200000)
+		return NULL;
+
+	p = PSXM(addr);
+	e = PSXM(addr + len - 1);
+	if (p == NULL || e != p + len - 1)
+		return NULL;
+
+	return p;
+}
+
 typedef struct {
 	u32 desc;
 	s32 status;
@@ -485,6 +502,17 @@ void psxBios_strncpy() { // 0x1a
 
 void psxBios_strlen() { // 0x1b
 	char *p = (char *)Ra0;
+	u32 n;
+
+	if (p >= (char *)psxM && p < (char *)psxM + 0x200000) {
+		n = (char *)psxM + 0x200000 - p;
+		v0 = strnlen(p, n);
+		if (v0 < n) {
+			pc0 = ra;
+			return;
+		}
+	}
+
 	v0 = 0;
 	while (*p++) v0++;
 	pc0 = ra;
@@ -611,6 +639,16 @@ void psxBios_tolower() { // 0x26
 
 void psxBios_bcopy() { // 0x27
 	char *p1 = (char *)Ra1, *p2 = (char *)Ra0;
+	u8 *d = psxBios_range(a1, a2), *s = psxBios_range(a0, a2);
+
+	// forward byte copy, same as memmove unless dst is just above src
+	if (d != NULL && s != NULL && (d <= s || d >= s + a2)) {
+		memmove(d, s, a2);
+		a2 = -1;
+		pc0 = ra;
+		return;
+	}
+
 	while (a2-- > 0) *p1++ = *p2++;
 
 	pc0 = ra;
@@ -618,6 +656,15 @@ void psxBios_bcopy() { // 0x27
 
 void psxBios_bzero() { // 0x28
 	char *p = (char *)Ra0;
+	u8 *d = psxBios_range(a0, a1);
+
+	if (d != NULL) {
+		memset(d, 0, a1);
+		a1 = -1;
+		pc0 = ra;
+		return;
+	}
+
 	while (a1-- > 0) *p++ = '\0';
 
 	pc0 = ra;
@@ -626,8 +673,17 @@ void psxBios_bzero() { // 0x28
 void psxBios_bcmp() { // 0x29
 	char *p1 = (char *)Ra0, *p2 = (char *)Ra1;
 
+	u8 *b1 = psxBios_range(a0, a2), *b2 = psxBios_range(a1, a2);
+
 	if (a0 == 0 || a1 == 0) { v0 = 0; pc0 = ra; return; }
 
+	// the common all-equal case in bulk, mismatches keep the quirky loop
+	if (b1 != NULL && b2 != NULL && memcmp(b1, b2, a2) == 0) {
+		a2 = -1;
+		v0 = 0; pc0 = ra;
+		return;
+	}
+
 	while (a2-- > 0) {
 		if (*p1++ != *p2++) {
 			v0 = *p1 - *p2; // BUG: compare the NEXT byte
@@ -641,6 +697,15 @@ void psxBios_bcmp() { // 0x29
 
 void psxBios_memcpy() { // 0x2a
 	char *p1 = (char *)Ra0, *p2 = (char *)Ra1;
+	u8 *d = psxBios_range(a0, a2), *s = psxBios_range(a1, a2);
+
+	if (d != NULL && s != NULL && (d <= s || d >= s + a2)) {
+		memmove(d, s, a2);
+		a2 = -1;
+		v0 = a0; pc0 = ra;
+		return;
+	}
+
 	while (a2-- > 0) *p1++ = *p2++;
 
 	v0 = a0; pc0 = ra;
@@ -648,6 +713,15 @@ void psxBios_memcpy() { // 0x2a
 
 void psxBios_memset() { // 0x2b
 	char *p = (char *)Ra0;
+	u8 *d = psxBios_range(a0, a2);
+
+	if (d != NULL) {
+		memset(d, (char)a1, a2);
+		a2 = -1;
+		v0 = a0; pc0 = ra;
+		return;
+	}
+
 	while (a2-- > 0) *p++ = (char)a1;
 
 	v0 = a0; pc0 = ra;
@@ -655,13 +729,31 @@ void psxBios_memset() { // 0x2b
 
 void psxBios_memmove() { // 0x2c
 	char *p1 = (char *)Ra0, *p2 = (char *)Ra1;
+	u8 *d, *s;
 
 	if (p2 <= p1 && p2 + a2 > p1) {
+		d = psxBios_range(a0, a2 + 1);
+		s = psxBios_range(a1, a2 + 1);
+		if (d != NULL && s != NULL) {
+			memmove(d, s, a2 + 1);	// BUG kept: one byte too many
+			a2 = -1;
+			v0 = a0; pc0 = ra;
+			return;
+		}
+
 		a2++; // BUG: copy one more byte here
 		p1 += a2;
 		p2 += a2;
 		while (a2-- > 0) *--p1 = *--p2;
 	} else {
+		d = psxBios_range(a0, a2);
+		s = psxBios_range(a1, a2);
+		if (d != NULL && s != NULL) {
+			memmove(d, s, a2);
+			a2 = -1;
+			v0 = a0; pc0 = ra;
+			return;
+		}
 		while (a2-- > 0) *p1++ = *p2++;
 	}
 
@@ -127,6 +127,8 @@ typedef struct {
 	boolean RCntFix;
 	boolean UseNet;
 	boolean VSyncWA;
+	boolean CycleModel; // charge mult/div/GTE latencies, see psxInstrCycles()
+	boolean NoIdleSkip; // don't fast-forward polling loops, see psxTestIdleLoop()
 	u8 Cpu; // CPU_DYNAREC or CPU_INTERPRETER
 	u8 PsxType; // PSX_TYPE_NTSC or PSX_TYPE_PAL
 #ifdef _WIN32
@@ -64,7 +64,7 @@ void psxDma4(u32 madr, u32 bcr, u32 chcr) { // SPU
 			}
 			size = (bcr >> 16) * (bcr & 0xffff) * 2;
 			SPU_readDMAMem(ptr, size);
-			psxCpu->Clear(madr, size);
+			psxMemClearCode(madr, size / 2);
 			break;
 
 #ifdef PSXDMA_LOG
@@ -137,7 +137,7 @@ void psxDma2(u32 madr, u32 bcr, u32 chcr) { // GPU
 			// BA blocks * BS words (word = 32-bits)
 			size = (bcr >> 16) * (bcr & 0xffff);
 			GPU_readDataMem(ptr, size);
-			psxCpu->Clear(madr, size);
+			psxMemClearCode(madr, size);
 
 			// already 32-bit word size ((size * 4) / 4)
 			GPUDMA_INT(size / 4);
@@ -215,6 +215,7 @@ void psxDma6(u32 madr, u32 bcr, u32 chcr) {
 
 		// already 32-bit size
 		size = bcr;
+		psxMemClearCode(madr - (size - 1) * 4, size);
 
 		while (bcr--) {
 			*mem-- = SWAP32((madr - 4) & 0xffffff);
@@ -22,6 +22,7 @@
 */
 
 #include "psxhle.h"
+#include "psxbios.h"
 
 static void hleDummy() {
 	psxRegs.pc = psxRegs.GPR.n.ra;
@@ -89,8 +90,482 @@ static void hleExecRet() {
 	psxRegs.pc = psxRegs.GPR.n.ra;
 }
 
+/*
+ * Statically linked SDK library functions replaced by native code.
+ * The entry of a recognized function is patched with an HLE opcode
+ * for slot 6 that carries the native index in bits 8-23, so patched
+ * RAM stays meaningful in savestates - only ever append here.
+ */
+
+#define HLE_NATIVE	6
+#define HLESIG_MAXLEN	256	// words
+#define HLESIG_MINLEN	4
+
+/*
+ * Native versions of statically linked SDK library functions. These
+ * implement the C library semantics the games were compiled against,
+ * not the BIOS A0 table ones (which have their own quirks and register
+ * side effects), and only return v0.
+ */
+
+// host pointer for [addr, addr + len) if it is one contiguous block
+static u8 *hleRange(u32 addr, u32 len) {
+	u8 *p;
+
+	if (len == 0 || len > 0x200000)
+		return NULL;
+
+	p = PSXM(addr);
+	if (p == NULL || PSXM(addr + len - 1) != p + len - 1)
+		return NULL;
+
+	return p;
+}
+
+static u8 hleRead8(u32 addr) {
+	u8 *p = PSXM(addr);
+
+	return p != NULL ? *p : 0;
+}
+
+static void hleWrite8(u32 addr, u8 val) {
+	u8 *p = PSXM(addr);
+
+	if (p != NULL)
+		*p = val;
+}
+
+// the natives write RAM directly, so translated code there has to go
+// the same way as after guest stores
+static void hleWritten(u32 dst, u32 n) {
+	if (n > 0x200000)
+		n = 0x200000;
+	if (n > 0)
+		psxMemClearCode(dst & ~3, ((dst & 3) + n + 3) / 4);
+}
+
+static void hleCopy(u32 dst, u32 src, u32 n) {
+	u8 *d = hleRange(dst, n), *s = hleRange(src, n);
+	u32 i;
+
+	if (d != NULL && s != NULL)
+		memmove(d, s, n);
+	else if (dst - src < n) {
+		for (i = n; i > 0; i--)
+			hleWrite8(dst + i - 1, hleRead8(src + i - 1));
+	} else {
+		for (i = 0; i < n; i++)
+			hleWrite8(dst + i, hleRead8(src + i));
+	}
+
+	hleWritten(dst, n);
+}
+
+static s32 hleCompare(u32 a, u32 b, u32 n) {
+	u8 *p1 = hleRange(a, n), *p2 = hleRange(b, n);
+	int c1, c2;
+
+	if (p1 != NULL && p2 != NULL)
+		return memcmp(p1, p2, n);
+
+	for (; n > 0; n--) {
+		c1 = hleRead8(a++);
+		c2 = hleRead8(b++);
+		if (c1 != c2)
+			return c1 - c2;
+	}
+
+	return 0;
+}
+
+static u32 hleLen(u32 s) {
+	u32 n = 0;
+
+	while (n < 0x200000 && hleRead8(s + n) != 0)
+		n++;
+
+	return n;
+}
+
+static void hleRet(u32 val) {
+	psxRegs.GPR.n.v0 = val;
+	psxRegs.pc = psxRegs.GPR.n.ra;
+}
+
+static void hleMemcpy() {
+	hleCopy(psxRegs.GPR.n.a0, psxRegs.GPR.n.a1, psxRegs.GPR.n.a2);
+	hleRet(psxRegs.GPR.n.a0);
+}
+
+static void hleMemset() {
+	u32 d = psxRegs.GPR.n.a0, n = psxRegs.GPR.n.a2;
+	u8 *p = hleRange(d, n), c = psxRegs.GPR.n.a1;
+
+	if (p != NULL)
+		memset(p, c, n);
+	else
+		for (; n > 0; n--)
+			hleWrite8(d++, c);
+	hleWritten(psxRegs.GPR.n.a0, psxRegs.GPR.n.a2);
+
+	hleRet(psxRegs.GPR.n.a0);
+}
+
+static void hleMemcmp() {
+	hleRet(hleCompare(psxRegs.GPR.n.a0, psxRegs.GPR.n.a1, psxRegs.GPR.n.a2));
+}
+
+static void hleMemchr() {
+	u32 s = psxRegs.GPR.n.a0, n = psxRegs.GPR.n.a2;
+	u8 c = psxRegs.GPR.n.a1;
+
+	for (; n > 0; n--, s++) {
+		if (hleRead8(s) == c) {
+			hleRet(s);
+			return;
+		}
+	}
+
+	hleRet(0);
+}
+
+static void hleBcopy() {
+	hleCopy(psxRegs.GPR.n.a1, psxRegs.GPR.n.a0, psxRegs.GPR.n.a2);
+	psxRegs.pc = psxRegs.GPR.n.ra;
+}
+
+static void hleBzero() {
+	u32 d = psxRegs.GPR.n.a0, n = psxRegs.GPR.n.a1;
+	u8 *p = hleRange(d, n);
+
+	if (p != NULL)
+		memset(p, 0, n);
+	else
+		for (; n > 0; n--)
+			hleWrite8(d++, 0);
+	hleWritten(psxRegs.GPR.n.a0, psxRegs.GPR.n.a1);
+
+	psxRegs.pc = psxRegs.GPR.n.ra;
+}
+
+static void hleStrlen() {
+	hleRet(hleLen(psxRegs.GPR.n.a0));
+}
+
+static void hleStrcmp() {
+	u32 a = psxRegs.GPR.n.a0, b = psxRegs.GPR.n.a1;
+	int c1, c2;
+
+	do {
+		c1 = hleRead8(a++);
+		c2 = hleRead8(b++);
+	} while (c1 == c2 && c1 != 0);
+
+	hleRet(c1 - c2);
+}
+
+static void hleStrncmp() {
+	u32 a = psxRegs.GPR.n.a0, b = psxRegs.GPR.n.a1, n = psxRegs.GPR.n.a2;
+	int c1 = 0, c2 = 0;
+
+	for (; n > 0; n--) {
+		c1 = hleRead8(a++);
+		c2 = hleRead8(b++);
+		if (c1 != c2 || c1 == 0)
+			break;
+	}
+
+	hleRet(c1 - c2);
+}
+
+static void hleStrcpy() {
+	hleCopy(psxRegs.GPR.n.a0, psxRegs.GPR.n.a1, hleLen(psxRegs.GPR.n.a1) + 1);
+	hleRet(psxRegs.GPR.n.a0);
+}
+
+static void hleStrncpy() {
+	u32 d = psxRegs.GPR.n.a0, s = psxRegs.GPR.n.a1, n = psxRegs.GPR.n.a2;
+	u8 c;
+
+	// pads the rest of the buffer with zeroes, like the C library does
+	for (; n > 0; n--) {
+		c = hleRead8(s);
+		if (c != 0)
+			s++;
+		hleWrite8(d++, c);
+	}
+	hleWritten(psxRegs.GPR.n.a0, psxRegs.GPR.n.a2);
+
+	hleRet(psxRegs.GPR.n.a0);
+}
+
+static void hleStrcat() {
+	u32 d = psxRegs.GPR.n.a0, s = psxRegs.GPR.n.a1;
+
+	hleCopy(d + hleLen(d), s, hleLen(s) + 1);
+	hleRet(d);
+}
+
+static void hleStrncat() {
+	u32 d = psxRegs.GPR.n.a0, s = psxRegs.GPR.n.a1, n = psxRegs.GPR.n.a2, e;
+	u8 c;
+
+	e = d = d + hleLen(d);
+	for (; n > 0; n--) {
+		c = hleRead8(s++);
+		if (c == 0)
+			break;
+		hleWrite8(d++, c);
+	}
+	hleWrite8(d, 0);
+	hleWritten(e, d + 1 - e);
+
+	hleRet(psxRegs.GPR.n.a0);
+}
+
+static void hleStrchr() {
+	u32 s = psxRegs.GPR.n.a0;
+	u8 c = psxRegs.GPR.n.a1, ch;
+
+	// the terminating zero counts as part of the string
+	for (;; s++) {
+		ch = hleRead8(s);
+		if (ch == c) {
+			hleRet(s);
+			return;
+		}
+		if (ch == 0)
+			break;
+	}
+
+	hleRet(0);
+}
+
+static void hleStrrchr() {
+	u32 s = psxRegs.GPR.n.a0, found = 0;
+	u8 c = psxRegs.GPR.n.a1, ch;
+
+	for (;; s++) {
+		ch = hleRead8(s);
+		if (ch == c)
+			found = s;
+		if (ch == 0)
+			break;
+	}
+
+	hleRet(found);
+}
+
+static void hleAbs() {
+	s32 v = psxRegs.GPR.n.a0;
+
+	hleRet(v < 0 ? -v : v);
+}
+
+static const struct {
+	const char *name;
+	void (*func)();
+} hleNatives[] = {
+	{ "memcpy",  hleMemcpy },
+	{ "memset",  hleMemset },
+	{ "memmove", hleMemcpy },
+	{ "memcmp",  hleMemcmp },
+	{ "memchr",  hleMemchr },
+	{ "bcopy",   hleBcopy },
+	{ "bzero",   hleBzero },
+	{ "bcmp",    hleMemcmp },
+	{ "strlen",  hleStrlen },
+	{ "strcmp",  hleStrcmp },
+	{ "strncmp", hleStrncmp },
+	{ "strcpy",  hleStrcpy },
+	{ "strncpy", hleStrncpy },
+	{ "strcat",  hleStrcat },
+	{ "strncat", hleStrncat },
+	{ "strchr",  hleStrchr },
+	{ "strrchr", hleStrrchr },
+	{ "abs",     hleAbs },
+};
+
+#define HLE_NATIVE_COUNT (sizeof(hleNatives) / sizeof(hleNatives[0]))
+
+typedef struct {
+	u32 hash;
+	u32 len;
+	u32 native;
+} HleSig;
+
+static HleSig *hleSigs;
+static int hleSigCount;
+static int hleSigsLoaded;
+
+static void hleNative() {
+	u32 id = (PSXMu32(psxRegs.pc - 4) >> 8) & 0xffff;
+
+	if (id < HLE_NATIVE_COUNT)
+		hleNatives[id].func();
+	else
+		psxRegs.pc = psxRegs.GPR.n.ra;
+
+	psxBranchTest();
+}
+
+// signature database, "<name> <hash> <len>" per line, see hleSigHash()
+static void hleLoadSigs() {
+	char path[MAXPATHLEN], line[256], name[64];
+	u32 hash, len, i;
+	HleSig *tmp;
+	FILE *f;
+
+	hleSigsLoaded = 1;
+
+	snprintf(path, sizeof(path), "%shlesigs.txt", Config.BiosDir);
+	f = fopen(path, "r");
+	if (f == NULL)
+		return;
+
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (line[0] == '#' || sscanf(line, "%63s %x %u", name, &hash, &len) != 3)
+			continue;
+
+		for (i = 0; i < HLE_NATIVE_COUNT; i++)
+			if (strcmp(hleNatives[i].name, name) == 0)
+				break;
+		if (i == HLE_NATIVE_COUNT) {
+			SysPrintf("hlesigs: no native %s\n", name);
+			continue;
+		}
+
+		tmp = realloc(hleSigs, (hleSigCount + 1) * sizeof(hleSigs[0]));
+		if (tmp == NULL)
+			break;
+		hleSigs = tmp;
+		hleSigs[hleSigCount].hash = hash;
+		hleSigs[hleSigCount].len = len;
+		hleSigs[hleSigCount].native = i;
+		hleSigCount++;
+	}
+	fclose(f);
+
+	SysPrintf("hlesigs: %d signatures\n", hleSigCount);
+}
+
+/*
+ * FNV-1a over the whole function body, up to the delay slot of the
+ * first 'jr ra' that no branch inside the function jumps past (early
+ * returns are part of the body). The fields the linker relocates are
+ * masked out (jump targets, lui and the offsets used with lui loaded
+ * registers or gp), so the same library object matches wherever it
+ * got linked.
+ * Returns the length in words, 0 if there is no usable signature.
+ */
+static int hleSigHash(u32 start, u32 end, u32 *hash) {
+	u32 h = 2166136261u, addr, code, op, rs, target, luiregs = 0;
+	u32 bodyend = start;
+	int len, last = 0;
+
+	for (len = 0, addr = start; len < HLESIG_MAXLEN && addr < end; len++, addr += 4) {
+		code = PSXMu32(addr);
+		op = code >> 26;
+		rs = (code >> 21) & 0x1f;
+
+		if (op == 0x01 || (op >= 0x04 && op <= 0x07) || (op >= 0x14 && op <= 0x17)) {
+			target = addr + 4 + ((s32)(s16)code << 2);
+			// a loop back to the entry would hit the patched opcode
+			if (target == start)
+				return 0;
+			if (target > bodyend)
+				bodyend = target;
+		}
+		else if (op == 0x02) {
+			target = (addr & 0xf0000000) | ((code & 0x03ffffff) << 2);
+			if (target > bodyend && target < start + HLESIG_MAXLEN * 4)
+				bodyend = target;
+		}
+
+		if (op == 0x02 || op == 0x03)
+			code &= 0xfc000000;
+		else if (op == 0x0f) {
+			luiregs |= 1 << ((code >> 16) & 0x1f);
+			code &= 0xffff0000;
+		}
+		else if (op >= 0x08 && (op < 0x10 || op >= 0x20) &&
+		         (rs == 28 || ((luiregs >> rs) & 1)))
+			code &= 0xffff0000;
+
+		h = (h ^ code) * 16777619u;
+
+		if (last)
+			break;
+		if (code == 0x03e00008 && addr + 4 >= bodyend)
+			last = 1;
+	}
+
+	if (!last || len + 1 < HLESIG_MINLEN)
+		return 0;
+
+	*hash = h;
+	return len + 1;
+}
+
+// look for known library functions among the jal targets in a freshly
+// loaded executable and patch them to their native versions
+void psxHleSigScan(u32 addr, u32 size) {
+	u32 end, a, target, code, hash;
+	u8 *seen;
+	int i, len, patched = 0;
+
+	if (!hleSigsLoaded)
+		hleLoadSigs();
+#ifndef HLESIG_LOG
+	if (hleSigCount == 0)
+		return;
+#endif
+
+	addr &= ~3;
+	if ((addr & 0x1fffffff) >= 0x800000 || (addr & 0x1fffff) + size > 0x200000)
+		return;
+	end = addr + size;
+
+	seen = calloc((size >> 5) + 1, 1);
+	if (seen == NULL)
+		return;
+
+	for (a = addr; a < end; a += 4) {
+		code = PSXMu32(a);
+		if ((code >> 26) != 0x03)
+			continue;
+		target = (a & 0xf0000000) | ((code & 0x03ffffff) << 2);
+		if (target < addr || target >= end)
+			continue;
+		if (seen[(target - addr) >> 5] & (1 << (((target - addr) >> 2) & 7)))
+			continue;
+		seen[(target - addr) >> 5] |= 1 << (((target - addr) >> 2) & 7);
+
+		len = hleSigHash(target, end, &hash);
+		if (len == 0)
+			continue;
+#ifdef HLESIG_LOG
+		HLESIG_LOG("hlesig %08x: %08x %d\n", target, hash, len);
+#endif
+		for (i = 0; i < hleSigCount; i++) {
+			if (hleSigs[i].hash == hash && hleSigs[i].len == len) {
+				PSXMu32ref(target) = SWAPu32((0x3b << 26) |
+					(hleSigs[i].native << 8) | HLE_NATIVE);
+				psxMemClearCode(target, 1);
+				patched++;
+				break;
+			}
+		}
+	}
+
+	free(seen);
+
+	if (patched)
+		SysPrintf("hlesigs: %d library functions replaced\n", patched);
+}
+
 void (*psxHLEt[256])() = {
 	hleDummy, hleA0, hleB0, hleC0,
 	hleBootstrap, hleExecRet,
-	hleDummy, hleDummy
+	hleNative, hleDummy
 };
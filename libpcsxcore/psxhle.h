@@ -30,6 +30,8 @@ extern "C" {
 
 extern void (*psxHLEt[256])();
 
+void psxHleSigScan(u32 addr, u32 size);
+
 #ifdef __cplusplus
 }
 #endif
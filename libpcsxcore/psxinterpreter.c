@@ -30,6 +30,10 @@ static int branch = 0;
 static int branch2 = 0;
 static u32 branchPC;
 
+// last backward branch checked for being an idle loop
+static u32 idleBranch = ~0, idleTarget, idleFirst;
+static int idleLoop;
+
 // These macros are used to assemble the repassembler functions
 
 #ifdef PSXCPU_LOG
@@ -407,9 +411,30 @@ static int psxDelayBranchTest(u32 tar1) {
 	return psxDelayBranchExec(tmp2);
 }
 
-__inline void doBranch(u32 tar) {
+static int isIdleLoop(u32 tar, u32 bpc) {
+	u32 *code = (u32 *)PSXM(tar);
+
+	if (code == NULL)
+		return 0;
+	if (bpc != idleBranch || tar != idleTarget || *code != idleFirst) {
+		idleBranch = bpc;
+		idleTarget = tar;
+		idleFirst = *code;
+		idleLoop = psxTestIdleLoop(code, (bpc - tar) / 4 + 2, psxRegs.GPR.r);
+		if (idleLoop)
+			psxMemMarkCode(tar, bpc + 8 - tar);
+	}
+	// load bases set up before the loop may point elsewhere next time
+	else if (idleLoop)
+		idleLoop = psxTestIdleLoop(code, (bpc - tar) / 4 + 2, psxRegs.GPR.r);
+
+	return idleLoop;
+}
+
+static __inline void doBranch(u32 tar) {
 	u32 *code;
 	u32 tmp;
+	u32 bpc = psxRegs.pc - 4;
 
 	branch2 = branch = 1;
 	branchPC = tar;
@@ -465,6 +490,10 @@ __inline void doBranch(u32 tar) {
 	branch = 0;
 	psxRegs.pc = branchPC;
 
+	if (branchPC <= bpc && bpc - branchPC < IDLE_LOOP_MAX * 4 &&
+	    isIdleLoop(branchPC, bpc))
+		psxSkipToNextEvent();
+
 	psxBranchTest();
 }
 
@@ -499,7 +528,12 @@ void psxSLTU() 	{ if (!_Rd_) return; _rRd_ = _u32(_rRs_) < _u32(_rRt_); }	// Rd
 * Register mult/div & Register trap logic                *
 * Format:  OP rs, rt                                     *
 *********************************************************/
+// latency of the slow ops, see psxInstrCycles()
+#define CYCLE_MODEL() \
+	if (Config.CycleModel) psxRegs.cycle += psxInstrCycles(psxRegs.code)
+
 void psxDIV() {
+	CYCLE_MODEL();
 	if (_i32(_rRt_) != 0) {
 		_i32(_rLo_) = _i32(_rRs_) / _i32(_rRt_);
 		_i32(_rHi_) = _i32(_rRs_) % _i32(_rRt_);
@@ -507,6 +541,7 @@ void psxDIV() {
 }
 
 void psxDIVU() {
+	CYCLE_MODEL();
 	if (_rRt_ != 0) {
 		_rLo_ = _rRs_ / _rRt_;
 		_rHi_ = _rRs_ % _rRt_;
@@ -516,6 +551,8 @@ void psxDIVU() {
 void psxMULT() {
 	u64 res = (s64)((s64)_i32(_rRs_) * (s64)_i32(_rRt_));
 
+	CYCLE_MODEL();
+
 	psxRegs.GPR.n.lo = (u32)(res & 0xffffffff);
 	psxRegs.GPR.n.hi = (u32)((res >> 32) & 0xffffffff);
 }
@@ -523,6 +560,8 @@ void psxMULT() {
 void psxMULTU() {
 	u64 res = (u64)((u64)_u32(_rRs_) * (u64)_u32(_rRt_));
 
+	CYCLE_MODEL();
+
 	psxRegs.GPR.n.lo = (u32)(res & 0xffffffff);
 	psxRegs.GPR.n.hi = (u32)((res >> 32) & 0xffffffff);
 }
@@ -634,43 +673,93 @@ void psxJALR() {
 
 #define _oB_ (_u32(_rRs_) + _Imm_)
 
+// RAM accesses skip the LUT lookup and I/O checks of psxmem.c
+
+static inline u8 memRead8(u32 mem) {
+	if (psxMemIsRam(mem) && psxMemFast)
+		return psxMu8(mem);
+	return psxMemRead8(mem);
+}
+
+static inline u16 memRead16(u32 mem) {
+	if (psxMemIsRam(mem) && psxMemFast)
+		return psxMu16(mem);
+	return psxMemRead16(mem);
+}
+
+static inline u32 memRead32(u32 mem) {
+	if (psxMemIsRam(mem) && psxMemFast)
+		return psxMu32(mem);
+	return psxMemRead32(mem);
+}
+
+static inline void memWrite8(u32 mem, u8 value) {
+	if (psxMemIsRam(mem) && psxMemFast) {
+		psxMu8ref(mem) = value;
+		if (psxMemIsCode(mem))
+			psxCpu->Clear((mem & (~3)), 1);
+		return;
+	}
+	psxMemWrite8(mem, value);
+}
+
+static inline void memWrite16(u32 mem, u16 value) {
+	if (psxMemIsRam(mem) && psxMemFast) {
+		psxMu16ref(mem) = SWAPu16(value);
+		if (psxMemIsCode(mem))
+			psxCpu->Clear((mem & (~3)), 1);
+		return;
+	}
+	psxMemWrite16(mem, value);
+}
+
+static inline void memWrite32(u32 mem, u32 value) {
+	if (psxMemIsRam(mem) && psxMemFast) {
+		psxMu32ref(mem) = SWAPu32(value);
+		if (psxMemIsCode(mem))
+			psxCpu->Clear(mem, 1);
+		return;
+	}
+	psxMemWrite32(mem, value);
+}
+
 void psxLB() {
 	if (_Rt_) {
-		_i32(_rRt_) = (signed char)psxMemRead8(_oB_); 
+		_i32(_rRt_) = (signed char)memRead8(_oB_); 
 	} else {
-		psxMemRead8(_oB_); 
+		memRead8(_oB_); 
 	}
 }
 
 void psxLBU() {
 	if (_Rt_) {
-		_u32(_rRt_) = psxMemRead8(_oB_);
+		_u32(_rRt_) = memRead8(_oB_);
 	} else {
-		psxMemRead8(_oB_); 
+		memRead8(_oB_); 
 	}
 }
 
 void psxLH() {
 	if (_Rt_) {
-		_i32(_rRt_) = (short)psxMemRead16(_oB_);
+		_i32(_rRt_) = (short)memRead16(_oB_);
 	} else {
-		psxMemRead16(_oB_);
+		memRead16(_oB_);
 	}
 }
 
 void psxLHU() {
 	if (_Rt_) {
-		_u32(_rRt_) = psxMemRead16(_oB_);
+		_u32(_rRt_) = memRead16(_oB_);
 	} else {
-		psxMemRead16(_oB_);
+		memRead16(_oB_);
 	}
 }
 
 void psxLW() {
 	if (_Rt_) {
-		_u32(_rRt_) = psxMemRead32(_oB_);
+		_u32(_rRt_) = memRead32(_oB_);
 	} else {
-		psxMemRead32(_oB_);
+		memRead32(_oB_);
 	}
 }
 
@@ -680,7 +769,7 @@ u32 LWL_SHIFT[4] = { 24, 16, 8, 0 };
 void psxLWL() {
 	u32 addr = _oB_;
 	u32 shift = addr & 3;
-	u32 mem = psxMemRead32(addr & ~3);
+	u32 mem = memRead32(addr & ~3);
 
 	if (!_Rt_) return;
 	_u32(_rRt_) =	( _u32(_rRt_) & LWL_MASK[shift]) | 
@@ -702,7 +791,7 @@ u32 LWR_SHIFT[4] = { 0, 8, 16, 24 };
 void psxLWR() {
 	u32 addr = _oB_;
 	u32 shift = addr & 3;
-	u32 mem = psxMemRead32(addr & ~3);
+	u32 mem = memRead32(addr & ~3);
 
 	if (!_Rt_) return;
 	_u32(_rRt_) =	( _u32(_rRt_) & LWR_MASK[shift]) | 
@@ -718,9 +807,9 @@ void psxLWR() {
 	*/
 }
 
-void psxSB() { psxMemWrite8 (_oB_, _u8 (_rRt_)); }
-void psxSH() { psxMemWrite16(_oB_, _u16(_rRt_)); }
-void psxSW() { psxMemWrite32(_oB_, _u32(_rRt_)); }
+void psxSB() { memWrite8 (_oB_, _u8 (_rRt_)); }
+void psxSH() { memWrite16(_oB_, _u16(_rRt_)); }
+void psxSW() { memWrite32(_oB_, _u32(_rRt_)); }
 
 u32 SWL_MASK[4] = { 0xffffff00, 0xffff0000, 0xff000000, 0 };
 u32 SWL_SHIFT[4] = { 24, 16, 8, 0 };
@@ -728,9 +817,9 @@ u32 SWL_SHIFT[4] = { 24, 16, 8, 0 };
 void psxSWL() {
 	u32 addr = _oB_;
 	u32 shift = addr & 3;
-	u32 mem = psxMemRead32(addr & ~3);
+	u32 mem = memRead32(addr & ~3);
 
-	psxMemWrite32(addr & ~3,  (_u32(_rRt_) >> SWL_SHIFT[shift]) |
+	memWrite32(addr & ~3,  (_u32(_rRt_) >> SWL_SHIFT[shift]) |
 			     (  mem & SWL_MASK[shift]) );
 	/*
 	Mem = 1234.  Reg = abcd
@@ -748,9 +837,9 @@ u32 SWR_SHIFT[4] = { 0, 8, 16, 24 };
 void psxSWR() {
 	u32 addr = _oB_;
 	u32 shift = addr & 3;
-	u32 mem = psxMemRead32(addr & ~3);
+	u32 mem = memRead32(addr & ~3);
 
-	psxMemWrite32(addr & ~3,  (_u32(_rRt_) << SWR_SHIFT[shift]) |
+	memWrite32(addr & ~3,  (_u32(_rRt_) << SWR_SHIFT[shift]) |
 			     (  mem & SWR_MASK[shift]) );
 
 	/*
@@ -824,6 +913,7 @@ void psxCOP0() {
 }
 
 void psxCOP2() {
+	CYCLE_MODEL();
 	psxCP2[_Funct_]();
 }
 
@@ -899,6 +989,7 @@ static int intInit() {
 }
 
 static void intReset() {
+	idleBranch = ~0;
 }
 
 void intExecute() {
@@ -913,6 +1004,8 @@ void intExecuteBlock() {
 }
 
 static void intClear(u32 Addr, u32 Size) {
+	if (Addr + Size * 4 > idleTarget && Addr <= idleBranch + 4)
+		idleBranch = ~0;
 }
 
 static void intShutdown() {
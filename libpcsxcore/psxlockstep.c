@@ -0,0 +1,335 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02111-1307 USA.           *
+ ***************************************************************************/
+
+/*
+ * Lockstep differential testing of CPU backends.
+ *
+ * The parent forks one child per backend, each one running from an
+ * identical copy of the emulator (devices and plugins included). The
+ * parent then steps the children one ExecuteBlock() at a time and
+ * compares the registers they send back. A backend that runs further per
+ * step (a recompiled block can span several branches) is simply stepped
+ * less often: states are compared whenever both sides stop at the same
+ * cycle, which requires both to count cycles the same way. Not every
+ * backend does idle loop skipping or the extra instruction cycles, so
+ * the children run with both turned off.
+ */
+
+#include "psxlockstep.h"
+#include "psxmem.h"
+
+#ifndef _WIN32
+
+#include <stddef.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#define LS_NREGS	(offsetof(psxRegisters, intCycle) / 4)
+#define LS_PC		(offsetof(psxRegisters, pc) / 4)
+#define LS_CODE		(offsetof(psxRegisters, code) / 4)
+#define LS_CYCLE	(offsetof(psxRegisters, cycle) / 4)
+#define LS_MAX_LAG	100000	// steps of one side without a common stop
+#define LS_MAX_DIFFS	16
+
+enum {
+	LS_STEP,	// run a block, reply with registers
+	LS_HASH,	// reply with a hash of RAM and scratchpad/io
+	LS_DUMP,	// reply with RAM and scratchpad/io
+};
+
+struct ls_child {
+	const char *name;
+	pid_t pid;
+	int cmd, reply;
+	u32 regs[LS_NREGS];
+};
+
+static int ls_read(int fd, void *buf, size_t size) {
+	ssize_t ret;
+
+	while (size > 0) {
+		ret = read(fd, buf, size);
+		if (ret <= 0)
+			return -1;
+		buf = (char *)buf + ret;
+		size -= ret;
+	}
+	return 0;
+}
+
+static int ls_write(int fd, const void *buf, size_t size) {
+	ssize_t ret;
+
+	while (size > 0) {
+		ret = write(fd, buf, size);
+		if (ret <= 0)
+			return -1;
+		buf = (const char *)buf + ret;
+		size -= ret;
+	}
+	return 0;
+}
+
+static u32 ls_hash(const u32 *p, int words) {
+	u32 h = 0;
+	int i;
+
+	for (i = 0; i < words; i++)
+		h = ((h << 5) | (h >> 27)) ^ p[i];
+	return h;
+}
+
+static void ls_child_loop(R3000Acpu *cpu, int cmd_fd, int reply_fd) {
+	u32 h[2];
+	u8 cmd;
+
+	for (;;) {
+		if (ls_read(cmd_fd, &cmd, 1) != 0)
+			_exit(0);
+
+		switch (cmd) {
+		case LS_STEP:
+			cpu->ExecuteBlock();
+			if (ls_write(reply_fd, &psxRegs, LS_NREGS * 4) != 0)
+				_exit(0);
+			break;
+		case LS_HASH:
+			h[0] = ls_hash((u32 *)psxM, 0x200000 / 4);
+			h[1] = ls_hash((u32 *)psxH, 0x10000 / 4);
+			if (ls_write(reply_fd, h, sizeof(h)) != 0)
+				_exit(0);
+			break;
+		case LS_DUMP:
+			if (ls_write(reply_fd, psxM, 0x200000) != 0 ||
+			    ls_write(reply_fd, psxH, 0x10000) != 0)
+				_exit(0);
+			break;
+		default:
+			_exit(0);
+		}
+	}
+}
+
+static int ls_spawn(struct ls_child *c, R3000Acpu *cpu) {
+	int to[2], from[2];
+
+	if (pipe(to) != 0)
+		return -1;
+	if (pipe(from) != 0) {
+		close(to[0]); close(to[1]);
+		return -1;
+	}
+
+	fflush(stdout);
+	fflush(stderr);
+	c->pid = fork();
+	if (c->pid < 0)
+		return -1;
+
+	if (c->pid == 0) {
+		close(to[1]); close(from[0]);
+		Config.CycleModel = FALSE;
+		Config.NoIdleSkip = TRUE;
+		if (cpu != psxCpu && cpu->Init() != 0)
+			_exit(1);
+		cpu->Reset();
+		psxCpu = cpu; // so that DMA and friends clear the right backend
+		ls_child_loop(cpu, to[0], from[1]);
+		_exit(0);
+	}
+
+	close(to[0]); close(from[1]);
+	c->cmd = to[1];
+	c->reply = from[0];
+	return 0;
+}
+
+static int ls_request(struct ls_child *c, u8 cmd, void *reply, size_t size) {
+	if (ls_write(c->cmd, &cmd, 1) != 0 || ls_read(c->reply, reply, size) != 0) {
+		printf("lockstep: %s backend died\n", c->name);
+		return -1;
+	}
+	return 0;
+}
+
+static const char *ls_regname(int i) {
+	static char buf[16];
+
+	if (i < 32)
+		sprintf(buf, "r%d", i);
+	else if (i == 32)
+		return "lo";
+	else if (i == 33)
+		return "hi";
+	else if (i < 34 + 32)
+		sprintf(buf, "C0_%d", i - 34);
+	else if (i < 34 + 64)
+		sprintf(buf, "C2D%d", i - 34 - 32);
+	else if (i < 34 + 96)
+		sprintf(buf, "C2C%d", i - 34 - 64);
+	else if (i == LS_PC)
+		return "PC";
+	else if (i == LS_CYCLE)
+		return "cycle";
+	else
+		sprintf(buf, "word%d", i);
+	return buf;
+}
+
+static void ls_report_mem(struct ls_child *c) {
+	u32 *m[2];
+	int i, j, diffs = 0;
+
+	m[0] = malloc(0x210000);
+	m[1] = malloc(0x210000);
+	if (m[0] == NULL || m[1] == NULL)
+		goto out;
+	for (i = 0; i < 2; i++)
+		if (ls_request(&c[i], LS_DUMP, m[i], 0x210000) != 0)
+			goto out;
+
+	printf("%-10s %-10s %-10s\n", "address", c[0].name, c[1].name);
+	for (j = 0; j < 0x210000 / 4 && diffs < LS_MAX_DIFFS; j++) {
+		if (m[0][j] == m[1][j])
+			continue;
+		printf("%08x   %08x   %08x\n", j < 0x200000 / 4 ?
+			0x80000000 + j * 4 : 0x1f800000 + j * 4 - 0x200000,
+			m[0][j], m[1][j]);
+		diffs++;
+	}
+
+out:
+	free(m[0]);
+	free(m[1]);
+}
+
+static int ls_compare(struct ls_child *c, int mem_interval) {
+	u32 good_pc = c[0].regs[LS_PC], good_cycle = c[0].regs[LS_CYCLE];
+	u32 h[2][2];
+	unsigned int matched = 0, lag = 0;
+	int i, n;
+	s32 d;
+
+	for (;;) {
+		d = c[0].regs[LS_CYCLE] - c[1].regs[LS_CYCLE];
+		if (d != 0) {
+			// one side is ahead, let the other one catch up
+			if (++lag > LS_MAX_LAG) {
+				printf("lockstep: no common stop since %08x cycle %u\n",
+					good_pc, good_cycle);
+				return 1;
+			}
+			n = d < 0 ? 0 : 1;
+			if (ls_request(&c[n], LS_STEP, c[n].regs, LS_NREGS * 4) != 0)
+				return 1;
+			continue;
+		}
+		lag = 0;
+
+		c[1].regs[LS_CODE] = c[0].regs[LS_CODE]; // don't care
+		if (memcmp(c[0].regs, c[1].regs, LS_NREGS * 4) != 0) {
+			printf("lockstep: registers differ at cycle %u, "
+				"last match %08x cycle %u\n",
+				c[0].regs[LS_CYCLE], good_pc, good_cycle);
+			printf("%-10s %-10s %-10s\n", "reg", c[0].name, c[1].name);
+			for (i = 0; i < LS_NREGS; i++)
+				if (c[0].regs[i] != c[1].regs[i])
+					printf("%-10s %08x   %08x\n", ls_regname(i),
+						c[0].regs[i], c[1].regs[i]);
+			return 1;
+		}
+
+		if (++matched % mem_interval == 0) {
+			for (i = 0; i < 2; i++)
+				if (ls_request(&c[i], LS_HASH, h[i], sizeof(h[i])) != 0)
+					return 1;
+			if (memcmp(h[0], h[1], sizeof(h[0])) != 0) {
+				printf("lockstep: memory differs at %08x cycle %u, "
+					"last match %08x cycle %u\n", c[0].regs[LS_PC],
+					c[0].regs[LS_CYCLE], good_pc, good_cycle);
+				ls_report_mem(c);
+				return 1;
+			}
+		}
+
+		good_pc = c[0].regs[LS_PC];
+		good_cycle = c[0].regs[LS_CYCLE];
+		if ((matched & 0xfffff) == 0)
+			printf("lockstep: %u steps ok, cycle %u\n", matched, good_cycle);
+
+		for (i = 0; i < 2; i++)
+			if (ls_request(&c[i], LS_STEP, c[i].regs, LS_NREGS * 4) != 0)
+				return 1;
+	}
+}
+
+int psxLockstepRun(R3000Acpu *a, R3000Acpu *b, int mem_interval) {
+	struct ls_child c[2];
+	int i, ret;
+
+#ifndef USE_IX86_64
+	// new_dynarec only returns from ExecuteBlock() when stopped, and
+	// without it psxRec is the interpreter again
+	if (a == &psxRec || b == &psxRec) {
+		printf("lockstep: psxRec can't be stepped per block in this build, "
+			"needs USE_IX86_64\n");
+		return -1;
+	}
+#endif
+
+	memset(c, 0, sizeof(c));
+	c[0].name = a == &psxInt ? "interp" : "rec";
+	c[1].name = b == &psxInt ? "interp" : "rec";
+	if (mem_interval < 1)
+		mem_interval = 1;
+
+	signal(SIGPIPE, SIG_IGN);
+	if (ls_spawn(&c[0], a) != 0)
+		return -1;
+	if (ls_spawn(&c[1], b) != 0) {
+		kill(c[0].pid, SIGKILL);
+		return -1;
+	}
+
+	printf("lockstep: comparing %s and %s, memory every %d steps\n",
+		c[0].name, c[1].name, mem_interval);
+
+	ret = 1;
+	for (i = 0; i < 2; i++)
+		if (ls_request(&c[i], LS_STEP, c[i].regs, LS_NREGS * 4) != 0)
+			break;
+	if (i == 2)
+		ret = ls_compare(c, mem_interval);
+
+	for (i = 0; i < 2; i++) {
+		close(c[i].cmd);
+		close(c[i].reply);
+		kill(c[i].pid, SIGKILL);
+		waitpid(c[i].pid, NULL, 0);
+	}
+	exit(ret);
+}
+
+#else
+
+int psxLockstepRun(R3000Acpu *a, R3000Acpu *b, int mem_interval) {
+	return -1;
+}
+
+#endif
@@ -0,0 +1,42 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02111-1307 USA.           *
+ ***************************************************************************/
+
+#ifndef __PSXLOCKSTEP_H__
+#define __PSXLOCKSTEP_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "r3000a.h"
+
+/*
+ * Runs two CPU backends side by side from the current emulator state
+ * and stops at the first point where they disagree. Each backend gets
+ * its own forked copy of the whole emulator, RAM and scratchpad are
+ * compared every mem_interval steps (1 pins down the exact block that
+ * wrote something different). psxRec can only take part when it is a
+ * recompiler that returns after each block (USE_IX86_64 builds).
+ * Only returns on error, otherwise runs until the backends disagree or
+ * one of them dies and exits with 1.
+ */
+int psxLockstepRun(R3000Acpu *a, R3000Acpu *b, int mem_interval);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
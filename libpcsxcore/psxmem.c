@@ -40,6 +40,11 @@ s8 *psxH = NULL; // Scratch Pad (1K) & Hardware Registers (8K)
 u8 **psxMemWLUT = NULL;
 u8 **psxMemRLUT = NULL;
 
+static int writeok = 1;
+int psxMemFast = 1;
+
+u8 psxCodePages[0x200000 >> 12];
+
 /*  Playstation Memory Map (from Playstation doc by Joshua Walker)
 0x0000_0000-0x0000_ffff		Kernel (64K)
 0x0001_0000-0x001f_ffff		User Memory (1.9 Meg)
@@ -116,6 +121,9 @@ void psxMemReset() {
 	memset(psxM, 0, 0x00200000);
 	memset(psxP, 0, 0x00010000);
 
+	psxMemFast = writeok && !Config.Debug;
+	memset(psxCodePages, 0, sizeof(psxCodePages));
+
 	if (strcmp(Config.Bios, "HLE") != 0) {
 		sprintf(bios, "%s/%s", Config.BiosDir, Config.Bios);
 		f = fopen(bios, "rb");
@@ -140,8 +148,6 @@ void psxMemShutdown() {
 	free(psxMemWLUT);
 }
 
-static int writeok = 1;
-
 u8 psxMemRead8(u32 mem) {
 	char *p;
 	u32 t;
@@ -233,9 +239,8 @@ void psxMemWrite8(u32 mem, u8 value) {
 			if (Config.Debug)
 				DebugCheckBP((mem & 0xffffff) | 0x80000000, W1);
 			*(u8 *)(p + (mem & 0xffff)) = value;
-#ifdef PSXREC
-			psxCpu->Clear((mem & (~3)), 1);
-#endif
+			if (psxMemIsCode(mem))
+				psxCpu->Clear((mem & (~3)), 1);
 		} else {
 #ifdef PSXMEM_LOG
 			PSXMEM_LOG("err sb %8.8lx\n", mem);
@@ -260,9 +265,8 @@ void psxMemWrite16(u32 mem, u16 value) {
 			if (Config.Debug)
 				DebugCheckBP((mem & 0xffffff) | 0x80000000, W2);
 			*(u16 *)(p + (mem & 0xffff)) = SWAPu16(value);
-#ifdef PSXREC
-			psxCpu->Clear((mem & (~3)), 1);
-#endif
+			if (psxMemIsCode(mem))
+				psxCpu->Clear((mem & (~3)), 1);
 		} else {
 #ifdef PSXMEM_LOG
 			PSXMEM_LOG("err sh %8.8lx\n", mem);
@@ -288,9 +292,8 @@ void psxMemWrite32(u32 mem, u32 value) {
 			if (Config.Debug)
 				DebugCheckBP((mem & 0xffffff) | 0x80000000, W4);
 			*(u32 *)(p + (mem & 0xffff)) = SWAPu32(value);
-#ifdef PSXREC
-			psxCpu->Clear(mem, 1);
-#endif
+			if (psxMemIsCode(mem))
+				psxCpu->Clear(mem, 1);
 		} else {
 			if (mem != 0xfffe0130) {
 #ifdef PSXREC
@@ -308,6 +311,7 @@ void psxMemWrite32(u32 mem, u32 value) {
 					case 0x800: case 0x804:
 						if (writeok == 0) break;
 						writeok = 0;
+						psxMemFast = 0;
 						memset(psxMemWLUT + 0x0000, 0, 0x80 * sizeof(void *));
 						memset(psxMemWLUT + 0x8000, 0, 0x80 * sizeof(void *));
 						memset(psxMemWLUT + 0xa000, 0, 0x80 * sizeof(void *));
@@ -315,6 +319,7 @@ void psxMemWrite32(u32 mem, u32 value) {
 					case 0x00: case 0x1e988:
 						if (writeok == 1) break;
 						writeok = 1;
+						psxMemFast = !Config.Debug;
 						for (i = 0; i < 0x80; i++) psxMemWLUT[i + 0x0000] = (void *)&psxM[(i & 0x1f) << 16];
 						memcpy(psxMemWLUT + 0x8000, psxMemWLUT, 0x80 * sizeof(void *));
 						memcpy(psxMemWLUT + 0xa000, psxMemWLUT, 0x80 * sizeof(void *));
@@ -348,3 +353,53 @@ void *psxMemPointer(u32 mem) {
 		return NULL;
 	}
 }
+
+/*
+ * Code page tracking. Backends report the RAM they translate code from,
+ * anything writing RAM other than through psxMemWrite (DMA, loaders)
+ * reports the range it wrote, and the backend gets psxCpu->Clear() calls
+ * only for the parts that overlap pages holding code.
+ * Pages stay marked until reset, backends may keep other blocks there.
+ */
+
+void psxMemMarkCode(u32 addr, u32 size) {
+	u32 p, end;
+
+	if (!psxMemIsRam(addr) || size == 0)
+		return;
+
+	end = (addr & 0x1fffff) + size - 1;
+	if (end > 0x1fffff)
+		end = 0x1fffff;
+	for (p = (addr & 0x1fffff) >> 12; p <= end >> 12; p++)
+		psxCodePages[p] = 1;
+}
+
+// size in words, like psxCpu->Clear()
+void psxMemClearCode(u32 addr, u32 size) {
+	u32 base, start, end, p, s, e;
+
+	if (!psxMemIsRam(addr) || size == 0)
+		return;
+
+	base = addr & ~0x1fffff;
+	start = addr & 0x1ffffc;
+	end = start + size * 4;
+	if (end > 0x200000)
+		end = 0x200000;
+
+	for (p = start >> 12; p <= (end - 1) >> 12; p++) {
+		if (!psxCodePages[p])
+			continue;
+
+		// merge with the following marked pages
+		s = p << 12;
+		while (p + 1 <= (end - 1) >> 12 && psxCodePages[p + 1])
+			p++;
+		e = (p + 1) << 12;
+
+		if (s < start) s = start;
+		if (e > end) e = end;
+		psxCpu->Clear(base | s, (e - s) >> 2);
+	}
+}
@@ -112,6 +112,16 @@ extern s8 *psxH;
 extern u8 **psxMemWLUT;
 extern u8 **psxMemRLUT;
 
+// RAM can be accessed directly, no debugger and no cache isolation
+extern int psxMemFast;
+
+// RAM and its mirrors in KUSEG, KSEG0 and KSEG1
+#define psxMemIsRam(mem) (((mem) & 0x1f800000) == 0 && ((0x31 >> ((mem) >> 29)) & 1))
+
+// 4K RAM pages that CPU backends have translated code from
+extern u8 psxCodePages[0x200000 >> 12];
+#define psxMemIsCode(mem) psxCodePages[((mem) & 0x1fffff) >> 12]
+
 #define PSXM(mem)		(psxMemRLUT[(mem) >> 16] == 0 ? NULL : (u8*)(psxMemRLUT[(mem) >> 16] + ((mem) & 0xffff)))
 #define PSXMs8(mem)		(*(s8 *)PSXM(mem))
 #define PSXMs16(mem)	(SWAP16(*(s16 *)PSXM(mem)))
@@ -137,6 +147,8 @@ void psxMemWrite8 (u32 mem, u8 value);
 void psxMemWrite16(u32 mem, u16 value);
 void psxMemWrite32(u32 mem, u32 value);
 void *psxMemPointer(u32 mem);
+void psxMemMarkCode(u32 addr, u32 size);
+void psxMemClearCode(u32 addr, u32 size);
 
 #ifdef __cplusplus
 }
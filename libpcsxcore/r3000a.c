@@ -225,6 +225,163 @@ void psxJumpTest() {
 	}
 }
 
+/*
+ * Check if a short backward branch closes a side-effect free polling
+ * loop: code[] runs from the branch target to the delay slot, with the
+ * branch at code[count - 2]. Such a loop only loads, computes and
+ * compares, with no value carried from one iteration to the next, so
+ * it keeps doing the same thing until an event changes memory or
+ * hardware state and the CPU may skip ahead to that event.
+ * Every load address has to be known, so root counter polling can be
+ * told apart: built from constants in the loop, or when gpr is given
+ * (the live registers), from a register the loop doesn't write.
+ */
+int psxTestIdleLoop(const u32 *code, int count, const u32 *gpr) {
+	u32 c, op, rs, rt, dst, src, written = 0, defined = 0, lastload = 0;
+	u32 constm = 1, constv[32], addr;
+	int i, pass;
+
+	if (Config.NoIdleSkip || count < 2 || count > IDLE_LOOP_MAX)
+		return 0;
+
+	constv[0] = 0;
+
+	// pass 0 collects everything written in the loop, pass 1 checks
+	// that each such reg is set before it's read in the iteration
+	for (pass = 0; pass < 2; pass++) {
+		for (i = 0; i < count; i++) {
+			c = SWAP32(code[i]);
+			op = c >> 26;
+			rs = (c >> 21) & 0x1f;
+			rt = (c >> 16) & 0x1f;
+			src = dst = 0;
+
+			if (i == count - 2) {
+				if (op == 0x01 && (rt & 0x1e) == 0)	// BLTZ/BGEZ
+					src = 1 << rs;
+				else if (op == 0x04 || op == 0x05)	// BEQ/BNE
+					src = (1 << rs) | (1 << rt);
+				else if (op == 0x06 || op == 0x07)	// BLEZ/BGTZ
+					src = 1 << rs;
+				else if (op != 0x02)			// J
+					return 0;
+			}
+			else if (op == 0x00) {
+				switch (c & 0x3f) {
+					case 0x00: case 0x02: case 0x03:	// SLL/SRL/SRA
+						src = 1 << rt;
+						break;
+					case 0x04: case 0x06: case 0x07:	// SLLV/SRLV/SRAV
+					case 0x20: case 0x21: case 0x22: case 0x23:
+					case 0x24: case 0x25: case 0x26: case 0x27:
+					case 0x2a: case 0x2b:
+						src = (1 << rs) | (1 << rt);
+						break;
+					case 0x10: case 0x12:			// MFHI/MFLO, no mult in the loop
+						break;
+					default:
+						return 0;
+				}
+				dst = 1 << ((c >> 11) & 0x1f);
+			}
+			else if (op >= 0x08 && op <= 0x0f) {	// ALU immediate
+				src = op == 0x0f ? 0 : 1 << rs;
+				dst = 1 << rt;
+			}
+			else if (op == 0x20 || op == 0x21 || op == 0x23 ||
+			         op == 0x24 || op == 0x25) {	// LB/LH/LW/LBU/LHU
+				src = 1 << rs;
+				dst = 1 << rt;
+			}
+			else
+				return 0;
+
+			dst &= ~1;
+			if (pass == 0) {
+				written |= dst;
+				continue;
+			}
+
+			// a load result is not visible in the next slot (load delay)
+			if (src & (lastload | (written & ~defined)))
+				return 0;
+			defined |= dst;
+			lastload = 0;
+
+			if (op >= 0x20) {
+				// polling a root counter never settles, it only looks
+				// that way between events
+				if ((constm >> rs) & 1)
+					addr = constv[rs] + (s16)c;
+				else if (gpr != NULL && !((written >> rs) & 1))
+					addr = gpr[rs] + (s16)c;
+				else
+					return 0;
+				addr &= 0x1fffffff;
+				if (addr >= 0x1f801100 && addr < 0x1f801130)
+					return 0;
+				lastload = dst;
+				constm &= ~dst;
+			}
+			else if (op == 0x0f) {
+				constm |= dst;
+				constv[rt] = c << 16;
+			}
+			else if ((op == 0x09 || op == 0x0d) && ((constm >> rs) & 1)) {
+				constm |= dst;
+				constv[rt] = op == 0x09 ? constv[rs] + (s16)c : constv[rs] | (c & 0xffff);
+			}
+			else
+				constm &= ~dst;
+		}
+	}
+
+	return 1;
+}
+
+// nothing can happen before the next counter or interrupt event
+void psxSkipToNextEvent() {
+	s32 c, min;
+	int i;
+
+	min = psxNextCounter - (psxRegs.cycle - psxNextsCounter);
+	for (i = 0; i < 32; i++) {
+		if (!(psxRegs.interrupt & (1 << i)))
+			continue;
+		c = psxRegs.intCycle[i].cycle - (psxRegs.cycle - psxRegs.intCycle[i].sCycle);
+		if (c < min)
+			min = c;
+	}
+
+	if (min > 0)
+		psxRegs.cycle += min;
+}
+
+/*
+ * Cycles an instruction costs on top of the flat BIAS, charged when
+ * Config.CycleModel is set. mult/div results are not interlocked here,
+ * so their latency is paid at issue. Depends on the opcode only, so
+ * recompilers can fold it into the block cycle count at compile time.
+ */
+int psxInstrCycles(u32 code) {
+	switch (code >> 26) {
+	case 0x00: // SPECIAL
+		switch (code & 0x3f) {
+		case 0x18: case 0x19: // MULT, MULTU: 6-13 depending on operands
+			return 7;
+		case 0x1a: case 0x1b: // DIV, DIVU
+			return 34;
+		}
+		break;
+	case 0x12: // COP2
+		if (code & 0x02000000)
+			return gte_cycletab[code & 0x3f];
+		break;
+	}
+
+	return 0;
+}
+
 void psxExecuteBios() {
 	while (psxRegs.pc != 0x80030000)
 		psxCpu->ExecuteBlock();
@@ -276,6 +276,12 @@ void psxDelayTest(int reg, u32 bpc);
 void psxTestSWInts();
 void psxJumpTest();
 
+#define IDLE_LOOP_MAX 16 // words from the loop start to the delay slot
+
+int  psxTestIdleLoop(const u32 *code, int count, const u32 *gpr);
+void psxSkipToNextEvent();
+int  psxInstrCycles(u32 code);
+
 #ifdef __cplusplus
 }
 #endif
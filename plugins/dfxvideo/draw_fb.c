@@ -28,6 +28,9 @@ static void blit(void)
  int pitch = PreviousPSXDisplay.DisplayMode.x;
  unsigned short *srcs = psxVuw + py * 1024 + px;
  unsigned char *dest = pl_fbdev_buf;
+ struct blit_dirty_layout layout;
+ unsigned int since;
+ int y, hud_y;
 
  if (w <= 0)
    return;
@@ -40,25 +43,39 @@ static void blit(void)
  #define bgr888_to_rgb888 bgr888_to_rgb565
 #endif
 
+ // frontend may have drawn text over these
+ hud_y = h - PL_HUD_LINES;
+
  // account for centering
  h -= PreviousPSXDisplay.Range.y0;
  dest += PreviousPSXDisplay.Range.y0 / 2 * pitch;
  dest += (PreviousPSXDisplay.Range.x0 & ~3) * 2; // must align here too..
+ hud_y -= PreviousPSXDisplay.Range.y0 / 2;
+
+ layout.x = px; layout.y = py;
+ layout.w = w;  layout.h = h;
+ layout.bpp = PSXDisplay.RGB24 ? 24 : 16;
+ layout.ofs = dest - (unsigned char *)pl_fbdev_buf;
+ since = blit_dirty_begin(&vram_dirty, pl_fbdev_buf, &layout);
 
  if (PSXDisplay.RGB24)
  {
-   for (; h-- > 0; dest += pitch, srcs += 1024)
+   for (y = 0; y < h; y++, dest += pitch, srcs += 1024)
    {
-     bgr888_to_rgb888(dest, srcs, w * 3);
+     if (blit_dirty_line(&vram_dirty, since, py + y) || y >= hud_y)
+       bgr888_to_rgb888(dest, srcs, w * 3);
    }
  }
  else
  {
-   for (; h-- > 0; dest += pitch, srcs += 1024)
+   for (y = 0; y < h; y++, dest += pitch, srcs += 1024)
    {
-     bgr555_to_rgb565(dest, srcs, w * 2);
+     if (blit_dirty_line(&vram_dirty, since, py + y) || y >= hud_y)
+       bgr555_to_rgb565(dest, srcs, w * 2);
    }
  }
+
+ blit_dirty_end(&vram_dirty, pl_fbdev_buf, &layout);
 }
 
 void DoBufferSwap(void)
@@ -76,6 +93,7 @@ void DoBufferSwap(void)
   fbh = PreviousPSXDisplay.DisplayMode.y;
   fb24bpp = PSXDisplay.RGB24;
   pl_fbdev_set_mode(fbw, fbh, fb24bpp ? 24 : 16);
+  blit_dirty_invalidate(&vram_dirty);
  }
 
  pcnt_start(PCNT_BLIT);
@@ -94,6 +112,8 @@ unsigned long ulInitDisplay(void)
  if (pl_fbdev_open() != 0)
   return 0;
 
+ blit_dirty_invalidate(&vram_dirty);
+
  return 1; /* ok */
 }
 
@@ -62,6 +62,7 @@ BOOL              bDoLazyUpdate=FALSE;
 uint32_t          lGPUInfoVals[16];
 static int        iFakePrimBusy=0;
 static uint32_t   vBlank=0;
+struct blit_dirty vram_dirty;
 
 ////////////////////////////////////////////////////////////////////////
 // some misc external display funcs
@@ -109,6 +110,9 @@ long CALLBACK GPUinit(void)                                // GPU INIT
  memset(psxVSecure,0x00,(512*2)*1024 + (1024*1024));
  memset(lGPUInfoVals,0x00,16*sizeof(uint32_t));
 
+ blit_dirty_invalidate(&vram_dirty);
+ blit_dirty_mark_all(&vram_dirty);
+
  PSXDisplay.RGB24        = FALSE;                      // init some stuff
  PSXDisplay.Interlaced   = FALSE;
  PSXDisplay.DrawOffset.x = 0;
@@ -887,6 +891,14 @@ static const unsigned char primTableCX[256] =
     0,0,0,0,0,0,0,0
 };
 
+// frame skip: only keep the state a skipped draw packet changes,
+// which is the texture page of textured polys (visible in status)
+static inline void primSkipFast(unsigned char command, uint32_t * pMem)
+{
+ if(command<0x40 && (command&0x24)==0x24)
+  UpdateGlobalTP((unsigned short)(GETLE32(&pMem[(command&0x10)?5:4])>>16));
+}
+
 void CALLBACK GPUwriteDataMem(uint32_t * pMem, int iSize)
 {
  unsigned char command;
@@ -967,6 +979,17 @@ ENDVRAM:
      if(gpuDataC == 0)
       {
        command = (unsigned char)((gdata>>24) & 0xff);
+
+       // skipping: drop complete draw packets without copying them
+       if(bSkipNextFrame && command>=0x20 && command<0x80 &&
+          primTableCX[command] && primTableCX[command]<128 &&
+          i-1+primTableCX[command]<=iSize)
+        {
+         primSkipFast(command, pMem-1);
+         pMem+=primTableCX[command]-1; i+=primTableCX[command]-1;
+         gdata=GETLE32(pMem-1);
+         continue;
+        }
  
 //if(command>=0xb0 && command<0xc0) auxprintf("b0 %x!!!!!!!!!\n",command);
 
@@ -997,6 +1020,8 @@ ENDVRAM:
      if(gpuDataP == gpuDataC)
       {
        gpuDataC=gpuDataP=0;
+       if(gpuCommand>=0x20 && gpuCommand<0x80 && !bSkipNextFrame)
+        blit_dirty_draw(&vram_dirty, drawY, drawH);    // prims stay inside draw area
        primFunc[gpuCommand]((unsigned char *)gpuDataM);
        if(dwActFixes&0x0400)      // hack for emulating "gpu busy" in some games
         iFakePrimBusy=4;
@@ -1111,6 +1136,7 @@ long CALLBACK GPUfreeze(uint32_t ulGetFreezeData,GPUFreeze_t * pF)
  lGPUstatusRet=pF->ulStatus;
  memcpy(ulStatusControl,pF->ulControl,256*sizeof(uint32_t));
  memcpy(psxVub,         pF->psxVRam,  1024*512*2);
+ blit_dirty_mark_all(&vram_dirty);
 
 // RESET TEXTURE STORE HERE, IF YOU USE SOMETHING LIKE THAT
 
@@ -65,6 +65,8 @@
 #include <stdint.h>
 #include <unistd.h>
 
+#include "blit_dirty.h"
+
 /////////////////////////////////////////////////////////////////////////////
 
 // byteswappings
@@ -295,6 +297,7 @@ extern BOOL           bInitCap;
 extern DWORD          dwLaceCnt;
 extern uint32_t  lGPUInfoVals[];
 extern uint32_t  ulStatusControl[];
+extern struct blit_dirty vram_dirty;
 
 // fps.c
 
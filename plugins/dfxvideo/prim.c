@@ -485,6 +485,8 @@ static void primLoadImage(unsigned char * baseAddr)
  VRAMWrite.ImagePtr = psxVuw + (VRAMWrite.y<<10) + VRAMWrite.x;
  VRAMWrite.RowsRemaining = VRAMWrite.Width;
  VRAMWrite.ColsRemaining = VRAMWrite.Height;
+
+ blit_dirty_mark(&vram_dirty, VRAMWrite.y, VRAMWrite.Height);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -534,6 +536,7 @@ static void primBlkFill(unsigned char * baseAddr)
  sH+=sY;
 
  FillSoftwareArea(sX, sY, sW, sH, BGR24to16(GETLE32(&gpuData[0])));
+ blit_dirty_mark(&vram_dirty, sY, sH - sY);
 
  bDoVSyncUpdate=TRUE;
 }
@@ -559,6 +562,8 @@ static void primMoveImage(unsigned char * baseAddr)
  if(imageSX<=0)  return;
  if(imageSY<=0)  return;
 
+ blit_dirty_mark(&vram_dirty, imageY1, imageSY);
+
  if((imageY0+imageSY)>512 ||
     (imageX0+imageSX)>1024       ||
     (imageY1+imageSY)>512 ||
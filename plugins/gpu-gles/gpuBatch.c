@@ -0,0 +1,255 @@
+/*
+ * (C) notaz, 2011
+ *
+ * This work is licensed under the terms of the GNU GPLv2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#define _IN_BATCH
+
+#include "gpuStdafx.h"
+#include "gpuExternals.h"
+#include "gpuBatch.h"
+
+#define BATCH_VERTS 1024                               // keep indices 16bit
+#define BATCH_IDX   (BATCH_VERTS * 3 / 2)
+
+static Vertex2        bVerts[BATCH_VERTS];
+static unsigned short bIdx[BATCH_IDX];
+static int            iBatchVerts, iBatchIdx;
+static Vec4f          bColor = { 255, 255, 255, 255 };  // GL current color
+unsigned int          batchDrawCount;
+
+// shadowed GL state, -1/~0 means unknown
+static GLuint  sTexName;
+static int     sTexKnown;
+static signed char sCaps[5];
+static const GLenum capList[5] =
+ { GL_BLEND, GL_TEXTURE_2D, GL_ALPHA_TEST, GL_SCISSOR_TEST, GL_DEPTH_TEST };
+static GLenum  sBlendS, sBlendD;
+static GLenum  sAlphaFunc;
+static GLclampf sAlphaRef;
+static GLenum  sShadeModel;
+static GLint   sScissor[4];
+static int     sScissorKnown;
+static GLenum  sDepthFunc;
+
+////////////////////////////////////////////////////////////////////////
+
+void batchReset(void)                                  // new context
+{
+ int i;
+
+ iBatchVerts = iBatchIdx = 0;
+ bColor.r = bColor.g = bColor.b = bColor.a = 255;
+ sTexKnown = 0;
+ for (i = 0; i < 5; i++) sCaps[i] = -1;
+ sBlendS = sBlendD = sAlphaFunc = sShadeModel = sDepthFunc = ~0u;
+ sAlphaRef = -1.0f;
+ sScissorKnown = 0;
+}
+
+void batchFlush(void)
+{
+ if (iBatchIdx == 0)
+  return;
+
+ glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+ glEnableClientState(GL_VERTEX_ARRAY);
+ glEnableClientState(GL_COLOR_ARRAY);
+ glTexCoordPointer(2, GL_FLOAT, sizeof(bVerts[0]), &bVerts[0].st);
+ glVertexPointer(3, GL_FLOAT, sizeof(bVerts[0]), &bVerts[0].xyz);
+ glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(bVerts[0]), &bVerts[0].rgba);
+
+ glDrawElements(GL_TRIANGLES, iBatchIdx, GL_UNSIGNED_SHORT, bIdx);
+
+ iBatchVerts = iBatchIdx = 0;
+ batchDrawCount++;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+static __inline void batchVertex(Vertex2 *d, OGLVertex *s,
+                                 OGLVertex *c, int flags)
+{
+ d->xyz.x = s->x;
+ d->xyz.y = s->y;
+ d->xyz.z = s->z;
+ d->st.x  = s->sow;
+ d->st.y  = s->tow;
+ if (flags & (BATCH_VCOL|BATCH_COL1))
+  {
+   d->rgba.r = c->c.col[0];
+   d->rgba.g = c->c.col[1];
+   d->rgba.b = c->c.col[2];
+   d->rgba.a = c->c.col[3];
+  }
+ else d->rgba = bColor;
+}
+
+void batchTri(OGLVertex *v1, OGLVertex *v2, OGLVertex *v3, int flags)
+{
+ Vertex2 *d;
+ int n;
+
+ if (iBatchVerts + 3 > BATCH_VERTS)
+  batchFlush();
+
+ n = iBatchVerts;
+ d = &bVerts[n];
+ batchVertex(d + 0, v1, v1, flags);
+ batchVertex(d + 1, v2, (flags & BATCH_COL1) ? v1 : v2, flags);
+ batchVertex(d + 2, v3, (flags & BATCH_COL1) ? v1 : v3, flags);
+ iBatchVerts += 3;
+
+ bIdx[iBatchIdx++] = n;
+ bIdx[iBatchIdx++] = n + 1;
+ bIdx[iBatchIdx++] = n + 2;
+}
+
+// v1-v4 in triangle strip order, split so that the
+// last (flat shading) vertex of each triangle stays the same
+void batchQuad(OGLVertex *v1, OGLVertex *v2,
+               OGLVertex *v3, OGLVertex *v4, int flags)
+{
+ Vertex2 *d;
+ int n;
+
+ if (iBatchVerts + 4 > BATCH_VERTS)
+  batchFlush();
+
+ n = iBatchVerts;
+ d = &bVerts[n];
+ batchVertex(d + 0, v1, v1, flags);
+ batchVertex(d + 1, v2, (flags & BATCH_COL1) ? v1 : v2, flags);
+ batchVertex(d + 2, v3, (flags & BATCH_COL1) ? v1 : v3, flags);
+ batchVertex(d + 3, v4, (flags & BATCH_COL1) ? v1 : v4, flags);
+ iBatchVerts += 4;
+
+ bIdx[iBatchIdx++] = n;
+ bIdx[iBatchIdx++] = n + 1;
+ bIdx[iBatchIdx++] = n + 2;
+ bIdx[iBatchIdx++] = n + 2;
+ bIdx[iBatchIdx++] = n + 1;
+ bIdx[iBatchIdx++] = n + 3;
+}
+
+////////////////////////////////////////////////////////////////////////
+// GL state wrappers
+////////////////////////////////////////////////////////////////////////
+
+void batchBindTexture(GLenum target, GLuint tex)
+{
+ if (sTexKnown && sTexName == tex)
+  return;
+ batchFlush();
+ glBindTexture(target, tex);
+ sTexName = tex;
+ sTexKnown = 1;
+}
+
+void batchDeleteTextures(GLsizei n, const GLuint *tex)
+{
+ int i;
+
+ batchFlush();
+ glDeleteTextures(n, tex);
+ for (i = 0; i < n; i++)                               // GL unbinds deleted ones
+  if (sTexKnown && tex[i] == sTexName)
+   sTexName = 0;
+}
+
+static int capIndex(GLenum cap)
+{
+ int i;
+ for (i = 0; i < 5; i++)
+  if (capList[i] == cap)
+   return i;
+ return -1;
+}
+
+void batchEnable(GLenum cap)
+{
+ int i = capIndex(cap);
+
+ if (i >= 0 && sCaps[i] == 1)
+  return;
+ batchFlush();
+ glEnable(cap);
+ if (i >= 0) sCaps[i] = 1;
+}
+
+void batchDisable(GLenum cap)
+{
+ int i = capIndex(cap);
+
+ if (i >= 0 && sCaps[i] == 0)
+  return;
+ batchFlush();
+ glDisable(cap);
+ if (i >= 0) sCaps[i] = 0;
+}
+
+void batchBlendFunc(GLenum sfactor, GLenum dfactor)
+{
+ if (sfactor == sBlendS && dfactor == sBlendD)
+  return;
+ batchFlush();
+ glBlendFunc(sfactor, dfactor);
+ sBlendS = sfactor;
+ sBlendD = dfactor;
+}
+
+void batchAlphaFunc(GLenum func, GLclampf ref)
+{
+ if (func == sAlphaFunc && ref == sAlphaRef)
+  return;
+ batchFlush();
+ glAlphaFunc(func, ref);
+ sAlphaFunc = func;
+ sAlphaRef = ref;
+}
+
+void batchAlphaFuncx(GLenum func, GLclampx ref)
+{
+ batchFlush();
+ glAlphaFuncx(func, ref);
+ sAlphaFunc = ~0u;                                     // not tracked
+}
+
+void batchShadeModel(GLenum mode)
+{
+ if (mode == sShadeModel)
+  return;
+ batchFlush();
+ glShadeModel(mode);
+ sShadeModel = mode;
+}
+
+void batchScissor(GLint x, GLint y, GLsizei w, GLsizei h)
+{
+ if (sScissorKnown && sScissor[0] == x && sScissor[1] == y &&
+     sScissor[2] == w && sScissor[3] == h)
+  return;
+ batchFlush();
+ glScissor(x, y, w, h);
+ sScissor[0] = x; sScissor[1] = y;
+ sScissor[2] = w; sScissor[3] = h;
+ sScissorKnown = 1;
+}
+
+void batchDepthFunc(GLenum func)
+{
+ if (func == sDepthFunc)
+  return;
+ batchFlush();
+ glDepthFunc(func);
+ sDepthFunc = func;
+}
+
+// color goes into the vertices, so no need to flush
+void batchColor4ub(GLubyte r, GLubyte g, GLubyte b, GLubyte a)
+{
+ bColor.r = r; bColor.g = g;
+ bColor.b = b; bColor.a = a;
+}
@@ -0,0 +1,80 @@
+/*
+ * (C) notaz, 2011
+ *
+ * This work is licensed under the terms of the GNU GPLv2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+/*
+ * Primitive batching. Prims are collected into one vertex/index array
+ * and drawn with a single call once some GL state they depend on changes.
+ * To make that safe, state changing GL calls in the plugin are redirected
+ * here: redundant ones are dropped, others flush the batch first.
+ * Prims are never reordered, PSX drawing order has to be kept.
+ */
+
+#ifndef _GPU_BATCH_H_
+#define _GPU_BATCH_H_
+
+struct OGLVertexTag;
+
+#define BATCH_VCOL  1                                  // per vertex color
+#define BATCH_COL1  2                                  // first vertex color for all
+
+extern unsigned int batchDrawCount;                   // bumped whenever the framebuffer changes
+
+void batchReset(void);
+void batchFlush(void);
+void batchTri(struct OGLVertexTag *v1, struct OGLVertexTag *v2,
+              struct OGLVertexTag *v3, int flags);
+void batchQuad(struct OGLVertexTag *v1, struct OGLVertexTag *v2,
+               struct OGLVertexTag *v3, struct OGLVertexTag *v4, int flags);
+
+void batchBindTexture(GLenum target, GLuint tex);
+void batchDeleteTextures(GLsizei n, const GLuint *tex);
+void batchEnable(GLenum cap);
+void batchDisable(GLenum cap);
+void batchBlendFunc(GLenum sfactor, GLenum dfactor);
+void batchAlphaFunc(GLenum func, GLclampf ref);
+void batchAlphaFuncx(GLenum func, GLclampx ref);
+void batchShadeModel(GLenum mode);
+void batchScissor(GLint x, GLint y, GLsizei w, GLsizei h);
+void batchDepthFunc(GLenum func);
+void batchColor4ub(GLubyte r, GLubyte g, GLubyte b, GLubyte a);
+
+#ifndef _IN_BATCH
+
+#define glBindTexture(t,n)        batchBindTexture(t,n)
+#define glDeleteTextures(n,t)     batchDeleteTextures(n,t)
+#define glEnable(c)               batchEnable(c)
+#define glDisable(c)              batchDisable(c)
+#define glBlendFunc(s,d)          batchBlendFunc(s,d)
+#define glAlphaFunc(f,r)          batchAlphaFunc(f,r)
+#define glAlphaFuncx(f,r)         batchAlphaFuncx(f,r)
+#define glShadeModel(m)           batchShadeModel(m)
+#define glScissor(x,y,w,h)        batchScissor(x,y,w,h)
+#define glDepthFunc(f)            batchDepthFunc(f)
+#define glColor4ub(r,g,b,a)       batchColor4ub(r,g,b,a)
+#define glColor4ubv(c)            batchColor4ub((c)[0],(c)[1],(c)[2],(c)[3])
+
+// anything touching buffers, textures or transforms needs pending prims drawn
+#define glClear(m)                (batchFlush(),batchDrawCount++,glClear(m))
+#define glTexImage2D(a,b,c,d,e,f,g,h,i)     (batchFlush(),glTexImage2D(a,b,c,d,e,f,g,h,i))
+#define glTexSubImage2D(a,b,c,d,e,f,g,h,i)  (batchFlush(),glTexSubImage2D(a,b,c,d,e,f,g,h,i))
+#define glCopyTexSubImage2D(a,b,c,d,e,f,g,h) (batchFlush(),glCopyTexSubImage2D(a,b,c,d,e,f,g,h))
+#define glTexParameteri(t,p,v)    (batchFlush(),glTexParameteri(t,p,v))
+#define glTexParameterf(t,p,v)    (batchFlush(),glTexParameterf(t,p,v))
+#define glTexEnvf(t,p,v)          (batchFlush(),glTexEnvf(t,p,v))
+#define glReadPixels(a,b,c,d,e,f,g) (batchFlush(),glReadPixels(a,b,c,d,e,f,g))
+#define glViewport(x,y,w,h)       (batchFlush(),glViewport(x,y,w,h))
+#define glMatrixMode(m)           (batchFlush(),glMatrixMode(m))
+#define glLoadIdentity()          (batchFlush(),glLoadIdentity())
+#define glOrthof(a,b,c,d,e,f)     (batchFlush(),glOrthof(a,b,c,d,e,f))
+#define glScalef(x,y,z)           (batchFlush(),glScalef(x,y,z))
+#define glFlush()                 (batchFlush(),glFlush())
+#define glFinish()                (batchFlush(),glFinish())
+#define eglSwapBuffers(d,s)       (batchFlush(),batchDrawCount++,eglSwapBuffers(d,s))
+
+#endif // _IN_BATCH
+
+#endif // _GPU_BATCH_H_
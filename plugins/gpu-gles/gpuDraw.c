@@ -270,6 +270,8 @@ void SetExtGLFuncs(void)
 
  LoadSubTexFn=LoadSubTexturePageSort;                  // init load tex ptr
 
+ InitRenderStates();                                   // prebuild blend states
+
  bBlendEnable=FALSE;                                   // init blending: off
  glDisable(GL_BLEND);
 
@@ -529,6 +531,7 @@ int GLinitialize()
 #ifdef MAEMO_CHANGES
 	 maemoGLinit();
 #endif
+ batchReset();                                         // new context, GL state unknown
  //----------------------------------------------------// 
 
  glViewport(rRatioRect.left,                           // init viewport by ratio rect
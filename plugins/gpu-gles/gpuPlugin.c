@@ -1719,6 +1719,52 @@ __inline void FinishedVRAMRead(void)
  STATUSREG&=~GPUSTATUS_READYFORVRAM;
 }
 
+////////////////////////////////////////////////////////////////////////
+// gfx card screen read back cache. glReadPixels is synchronous and
+// stalls until all drawing is done, that still happens on the first
+// read after anything got drawn. The read area is kept though, and
+// later reads inside it are served from the copy until the next draw,
+// so a transfer read in several chunks only waits once.
+// Data is GL_RGBA, the returned pitch is in bytes.
+////////////////////////////////////////////////////////////////////////
+
+static int          iSnapX,iSnapY,iSnapDX,iSnapDY;
+static unsigned int uiSnapSerial;
+static BOOL         bSnapValid=FALSE;
+
+static u8 * ReadGfxCardScreen(int x, int y, int dx, int dy, int * pitch)
+{
+ if(!pGfxCardScreen)
+  {
+   glPixelStorei(GL_PACK_ALIGNMENT,1);
+   pGfxCardScreen=(u8 *)malloc(iResX*iResY*4);
+   bSnapValid=FALSE;
+  }
+
+#ifdef _GPU_BATCH_H_
+ batchFlush();                                         // pending prims count as drawn
+ if(bSnapValid && uiSnapSerial==batchDrawCount &&
+    x>=iSnapX && y>=iSnapY &&
+    x+dx<=iSnapX+iSnapDX && y+dy<=iSnapY+iSnapDY)
+  {
+   *pitch=iSnapDX*4;
+   return pGfxCardScreen+((y-iSnapY)*iSnapDX+(x-iSnapX))*4;
+  }
+#endif
+
+ // RGBA is the one format every GLES driver reads back without conversion
+ glReadPixels(x,y,dx,dy,GL_RGBA,GL_UNSIGNED_BYTE,pGfxCardScreen);
+
+ iSnapX=x;iSnapY=y;iSnapDX=dx;iSnapDY=dy;
+#ifdef _GPU_BATCH_H_
+ uiSnapSerial=batchDrawCount;
+ bSnapValid=TRUE;
+#endif
+
+ *pitch=dx*4;
+ return pGfxCardScreen;
+}
+
 ////////////////////////////////////////////////////////////////////////
 // vram read check ex (reading from card's back/frontbuffer if needed...
 // slow!)
@@ -1733,6 +1779,7 @@ void CheckVRamReadEx(int x, int y, int dx, int dy)
  u8 * ps;
  u8 * px;
  unsigned short s,sx;
+ int pitch;
 
  if(STATUSREG&GPUSTATUS_RGB24) return;
 
@@ -1825,17 +1872,9 @@ void CheckVRamReadEx(int x, int y, int dx, int dy)
 
  if(y<0) y=0; if((y+dy)>iResY) dy=iResY-y;
 
- if(!pGfxCardScreen)
-  {
-   glPixelStorei(GL_PACK_ALIGNMENT,1);
-   pGfxCardScreen=(u8 *)malloc(iResX*iResY*4);
-  }
-
- ps=pGfxCardScreen;
- 
  //if(!sArea) glReadBuffer(GL_FRONT);
 
- glReadPixels(x,y,dx,dy,GL_RGB,GL_UNSIGNED_BYTE,ps);
+ ps=ReadGfxCardScreen(x,y,dx,dy,&pitch);
                
  //if(!sArea) glReadBuffer(GL_BACK);
 
@@ -1850,8 +1889,8 @@ void CheckVRamReadEx(int x, int y, int dx, int dy)
     {
      if(p1>=psxVuw && p1<psxVuw_eom)
       {
-       px=ps+(3*((int)((float)x * XS))+
-             (3*dx)*((int)((float)y*YS)));
+       px=ps+(4*((int)((float)x * XS))+
+             pitch*((int)((float)y*YS)));
        sx=(*px)>>3;px++;
        s=sx;
        sx=(*px)>>3;px++;
@@ -1883,6 +1922,7 @@ void CheckVRamRead(int x, int y, int dx, int dy, bool bFront)
  int ux,uy,udx,udy,wx,wy;float XS,YS;
  u8 * ps, * px;
  unsigned short s=0,sx;
+ int pitch;
 
  if(STATUSREG&GPUSTATUS_RGB24) return;
 
@@ -1973,17 +2013,9 @@ void CheckVRamRead(int x, int y, int dx, int dy, bool bFront)
 
  if(y<0) y=0; if((y+dy)>iResY) dy=iResY-y;
 
- if(!pGfxCardScreen)
-  {
-   glPixelStorei(GL_PACK_ALIGNMENT,1);
-   pGfxCardScreen=(u8 *)malloc(iResX*iResY*4);
-  }
-
- ps=pGfxCardScreen;
- 
 // if(bFront) glReadBuffer(GL_FRONT);
 
- glReadPixels(x,y,dx,dy,GL_RGB,GL_UNSIGNED_BYTE,ps);
+ ps=ReadGfxCardScreen(x,y,dx,dy,&pitch);
                
 // if(bFront) glReadBuffer(GL_BACK);
 
@@ -1996,8 +2028,8 @@ void CheckVRamRead(int x, int y, int dx, int dy, bool bFront)
     {
      if(p>=psxVuw && p<psxVuw_eom)
       {
-       px=ps+(3*((int)((float)x * XS))+
-             (3*dx)*((int)((float)y*YS)));
+       px=ps+(4*((int)((float)x * XS))+
+             pitch*((int)((float)y*YS)));
        sx=(*px)>>3;px++;
        s=sx;
        sx=(*px)>>3;px++;
@@ -2856,6 +2888,7 @@ long CALLBACK GPUgetScreenPic(u8 * pMem)
   }
 
  ps=pGfxCardScreen;
+ bSnapValid=FALSE;
 
 // glReadBuffer(GL_FRONT);
 
@@ -46,7 +46,7 @@
 // defines
 ////////////////////////////////////////////////////////////////////////
 
-#define DEFOPAQUEON  glAlphaFunc(GL_EQUAL,0.0f);bBlendEnable=FALSE;glDisable(GL_BLEND);                                
+#define DEFOPAQUEON  glAlphaFunc(GL_EQUAL,0.0f);SetBlendEnable(FALSE);                                
 #define DEFOPAQUEOFF glAlphaFunc(GL_GREATER,0.49f);
 #define fpoint(x) x
 ////////////////////////////////////////////////////////////////////////                                          
@@ -234,44 +234,13 @@ unsigned short BGR24to16 (unsigned long BGR)
 // OpenGL primitive drawing commands
 ////////////////////////////////////////////////////////////////////////
 
+// all prims go through the batcher (gpuBatch.c), quads are passed
+// in triangle strip order
+
 __inline void PRIMdrawTexturedQuad(OGLVertex* vertex1, OGLVertex* vertex2, 
                                    OGLVertex* vertex3, OGLVertex* vertex4) 
 {
-
-
-Vertex v[4];
-
-v[0].xyz.x = fpoint(vertex1->x);
-v[0].xyz.y = fpoint(vertex1->y);
-v[0].xyz.z = fpoint(vertex1->z);
-v[0].st.x = fpoint(vertex1->sow);
-v[0].st.y = fpoint(vertex1->tow);
-
-v[1].xyz.x = fpoint(vertex2->x);
-v[1].xyz.y = fpoint(vertex2->y);
-v[1].xyz.z = fpoint(vertex2->z);
-v[1].st.x = fpoint(vertex2->sow);
-v[1].st.y = fpoint(vertex2->tow);
-
-v[2].xyz.x = fpoint(vertex4->x);
-v[2].xyz.y = fpoint(vertex4->y);
-v[2].xyz.z = fpoint(vertex4->z);
-v[2].st.x = fpoint(vertex4->sow);
-v[2].st.y = fpoint(vertex4->tow);
-
-v[3].xyz.x = fpoint(vertex3->x);
-v[3].xyz.y = fpoint(vertex3->y);
-v[3].xyz.z = fpoint(vertex3->z);
-v[3].st.x = fpoint(vertex3->sow);
-v[3].st.y = fpoint(vertex3->tow);
-
-glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-glEnableClientState(GL_VERTEX_ARRAY);
-glTexCoordPointer(2, GL_FLOAT, sizeof(v[0]), &v[0].st);
-glVertexPointer(3, GL_FLOAT, sizeof(v[0]), &v[0].xyz);
-glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-glDisableClientState(GL_VERTEX_ARRAY); 
+ batchQuad(vertex1, vertex2, vertex4, vertex3, 0);
 }
 
 ///////////////////////////////////////////////////////// 
@@ -279,34 +248,7 @@ glDisableClientState(GL_VERTEX_ARRAY);
 __inline void PRIMdrawTexturedTri(OGLVertex* vertex1, OGLVertex* vertex2, 
                                   OGLVertex* vertex3) 
 {
-Vertex v[3];
-
-v[0].xyz.x = fpoint(vertex1->x);
-v[0].xyz.y = fpoint(vertex1->y);
-v[0].xyz.z = fpoint(vertex1->z);
-v[0].st.x = fpoint(vertex1->sow);
-v[0].st.y = fpoint(vertex1->tow);
-
-v[1].xyz.x = fpoint(vertex2->x);
-v[1].xyz.y = fpoint(vertex2->y);
-v[1].xyz.z = fpoint(vertex2->z);
-v[1].st.x = fpoint(vertex2->sow);
-v[1].st.y = fpoint(vertex2->tow);
-
-v[2].xyz.x = fpoint(vertex3->x);
-v[2].xyz.y = fpoint(vertex3->y);
-v[2].xyz.z = fpoint(vertex3->z);
-v[2].st.x = fpoint(vertex3->sow);
-v[2].st.y = fpoint(vertex3->tow);
-
-glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-glEnableClientState(GL_VERTEX_ARRAY);
-glTexCoordPointer(2, GL_FLOAT, sizeof(v[0]), &v[0].st);
-glVertexPointer(3, GL_FLOAT, sizeof(v[0]), &v[0].xyz);
-glDrawArrays(GL_TRIANGLES, 0, 3);
-glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-glDisableClientState(GL_VERTEX_ARRAY);
-
+ batchTri(vertex1, vertex2, vertex3, 0);
 }
 
 ///////////////////////////////////////////////////////// 
@@ -314,51 +256,7 @@ glDisableClientState(GL_VERTEX_ARRAY);
 __inline void PRIMdrawTexGouraudTriColor(OGLVertex* vertex1, OGLVertex* vertex2, 
                                          OGLVertex* vertex3) 
 {
-
-Vertex2 v[3];
-
-v[0].xyz.x = fpoint(vertex1->x);
-v[0].xyz.y = fpoint(vertex1->y);
-v[0].xyz.z = fpoint(vertex1->z);
-v[0].st.x = fpoint(vertex1->sow);
-v[0].st.y = fpoint(vertex1->tow);
-v[0].rgba.r = vertex1->c.col[0];
-v[0].rgba.g = vertex1->c.col[1];
-v[0].rgba.b = vertex1->c.col[2];
-v[0].rgba.a = vertex1->c.col[3];
-
-v[1].xyz.x = fpoint(vertex2->x);
-v[1].xyz.y = fpoint(vertex2->y);
-v[1].xyz.z = fpoint(vertex2->z);
-v[1].st.x = fpoint(vertex2->sow);
-v[1].st.y = fpoint(vertex2->tow);
-v[1].rgba.r = vertex2->c.col[0];
-v[1].rgba.g = vertex2->c.col[1];
-v[1].rgba.b = vertex2->c.col[2];
-v[1].rgba.a = vertex2->c.col[3];
-
-v[2].xyz.x = fpoint(vertex3->x);
-v[2].xyz.y = fpoint(vertex3->y);
-v[2].xyz.z = fpoint(vertex3->z);
-v[2].st.x = fpoint(vertex3->sow);
-v[2].st.y = fpoint(vertex3->tow);
-v[2].rgba.r = vertex3->c.col[0];
-v[2].rgba.g = vertex3->c.col[1];
-v[2].rgba.b = vertex3->c.col[2];
-v[2].rgba.a = vertex3->c.col[3];
-
-glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-glEnableClientState(GL_VERTEX_ARRAY);
-glEnableClientState(GL_COLOR_ARRAY);
-
-glTexCoordPointer(2, GL_FLOAT, sizeof(v[0]), &v[0].st);
-glVertexPointer(3, GL_FLOAT, sizeof(v[0]), &v[0].xyz);
-glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(v[0]), &v[0].rgba);
-
-glDrawArrays(GL_TRIANGLES, 0, 3);
-glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-glDisableClientState(GL_VERTEX_ARRAY);
-glDisableClientState(GL_COLOR_ARRAY);
+ batchTri(vertex1, vertex2, vertex3, BATCH_VCOL);
 }
 
 ///////////////////////////////////////////////////////// 
@@ -366,84 +264,14 @@ glDisableClientState(GL_COLOR_ARRAY);
 __inline void PRIMdrawTexGouraudTriColorQuad(OGLVertex* vertex1, OGLVertex* vertex2, 
                                              OGLVertex* vertex3, OGLVertex* vertex4) 
 {
-Vertex2 v[4];
-
-v[0].xyz.x = fpoint(vertex1->x);
-v[0].xyz.y = fpoint(vertex1->y);
-v[0].xyz.z = fpoint(vertex1->z);
-v[0].st.x = fpoint(vertex1->sow);
-v[0].st.y = fpoint(vertex1->tow);
-v[0].rgba.r = vertex1->c.col[0];
-v[0].rgba.g = vertex1->c.col[1];
-v[0].rgba.b = vertex1->c.col[2];
-v[0].rgba.a = vertex1->c.col[3];
-
-v[1].xyz.x = fpoint(vertex2->x);
-v[1].xyz.y = fpoint(vertex2->y);
-v[1].xyz.z = fpoint(vertex2->z);
-v[1].st.x = fpoint(vertex2->sow);
-v[1].st.y = fpoint(vertex2->tow);
-v[1].rgba.r = vertex2->c.col[0];
-v[1].rgba.g = vertex2->c.col[1];
-v[1].rgba.b = vertex2->c.col[2];
-v[1].rgba.a = vertex2->c.col[3];
-
-v[2].xyz.x = fpoint(vertex4->x);
-v[2].xyz.y = fpoint(vertex4->y);
-v[2].xyz.z = fpoint(vertex4->z);
-v[2].st.x = fpoint(vertex4->sow);
-v[2].st.y = fpoint(vertex4->tow);
-v[2].rgba.r = vertex4->c.col[0];
-v[2].rgba.g = vertex4->c.col[1];
-v[2].rgba.b = vertex4->c.col[2];
-v[2].rgba.a = vertex4->c.col[3];
-
-v[3].xyz.x = fpoint(vertex3->x);
-v[3].xyz.y = fpoint(vertex3->y);
-v[3].xyz.z = fpoint(vertex3->z);
-v[3].st.x = fpoint(vertex3->sow);
-v[3].st.y = fpoint(vertex3->tow);
-v[3].rgba.r = vertex3->c.col[0];
-v[3].rgba.g = vertex3->c.col[1];
-v[3].rgba.b = vertex3->c.col[2];
-v[3].rgba.a = vertex3->c.col[3];
-
-glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-glEnableClientState(GL_VERTEX_ARRAY);
-glEnableClientState(GL_COLOR_ARRAY);
-
-glTexCoordPointer(2, GL_FLOAT, sizeof(v[0]), &v[0].st);
-glVertexPointer(3, GL_FLOAT, sizeof(v[0]), &v[0].xyz);
-glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(v[0]), &v[0].rgba);
-
-glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-glDisableClientState(GL_VERTEX_ARRAY);
-glDisableClientState(GL_COLOR_ARRAY);
+ batchQuad(vertex1, vertex2, vertex4, vertex3, BATCH_VCOL);
 }
 
 ///////////////////////////////////////////////////////// 
 
 __inline void PRIMdrawTri(OGLVertex* vertex1, OGLVertex* vertex2, OGLVertex* vertex3) 
 {
-Vec3f v[3];
-
-v[0].x = fpoint(vertex1->x);
-v[0].y = fpoint(vertex1->y);
-v[0].z = fpoint(vertex1->z);
-
-v[1].x = fpoint(vertex2->x);
-v[1].y = fpoint(vertex2->y);
-v[1].z = fpoint(vertex2->z);
-
-v[2].x = fpoint(vertex3->x);
-v[2].y = fpoint(vertex3->y);
-v[2].z = fpoint(vertex3->z);
-
-glEnableClientState(GL_VERTEX_ARRAY);
-glVertexPointer(3, GL_FLOAT, sizeof(v[0]), &v[0]);
-glDrawArrays(GL_TRIANGLES, 0, 3);
-glDisableClientState(GL_VERTEX_ARRAY);
+ batchTri(vertex1, vertex2, vertex3, 0);
 }
 
 ///////////////////////////////////////////////////////// 
@@ -451,28 +279,7 @@ glDisableClientState(GL_VERTEX_ARRAY);
 __inline void PRIMdrawTri2(OGLVertex* vertex1, OGLVertex* vertex2, 
                            OGLVertex* vertex3, OGLVertex* vertex4) 
 {
-Vec3f v[4];
-
-v[0].x = fpoint(vertex1->x);
-v[0].y = fpoint(vertex1->y);
-v[0].z = fpoint(vertex1->z);
-
-v[1].x = fpoint(vertex3->x);
-v[1].y = fpoint(vertex3->y);
-v[1].z = fpoint(vertex3->z);
-
-v[2].x = fpoint(vertex2->x);
-v[2].y = fpoint(vertex2->y);
-v[2].z = fpoint(vertex2->z);
-
-v[3].x = fpoint(vertex4->x);
-v[3].y = fpoint(vertex4->y);
-v[3].z = fpoint(vertex4->z);
-
-glEnableClientState(GL_VERTEX_ARRAY);
-glVertexPointer(3, GL_FLOAT, sizeof(v[0]), &v[0]);
-glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-glDisableClientState(GL_VERTEX_ARRAY);
+ batchQuad(vertex1, vertex3, vertex2, vertex4, 0);
 }
 
 ///////////////////////////////////////////////////////// 
@@ -480,41 +287,7 @@ glDisableClientState(GL_VERTEX_ARRAY);
 __inline void PRIMdrawGouraudTriColor(OGLVertex* vertex1, OGLVertex* vertex2, 
                                       OGLVertex* vertex3) 
 {
-Vertex2 v[3];
-
-v[0].xyz.x = fpoint(vertex1->x);
-v[0].xyz.y = fpoint(vertex1->y);
-v[0].xyz.z = fpoint(vertex1->z);
-v[0].rgba.r = vertex1->c.col[0];
-v[0].rgba.g = vertex1->c.col[1];
-v[0].rgba.b = vertex1->c.col[2];
-v[0].rgba.a = vertex1->c.col[3];
-
-v[1].xyz.x = fpoint(vertex2->x);
-v[1].xyz.y = fpoint(vertex2->y);
-v[1].xyz.z = fpoint(vertex2->z);
-v[1].rgba.r = vertex2->c.col[0];
-v[1].rgba.g = vertex2->c.col[1];
-v[1].rgba.b = vertex2->c.col[2];
-v[1].rgba.a = vertex2->c.col[3];
-
-v[2].xyz.x = fpoint(vertex3->x);
-v[2].xyz.y = fpoint(vertex3->y);
-v[2].xyz.z = fpoint(vertex3->z);
-v[2].rgba.r = vertex3->c.col[0];
-v[2].rgba.g = vertex3->c.col[1];
-v[2].rgba.b = vertex3->c.col[2];
-v[2].rgba.a = vertex3->c.col[3];
-
-glEnableClientState(GL_VERTEX_ARRAY);
-glEnableClientState(GL_COLOR_ARRAY);
-
-glVertexPointer(3, GL_FLOAT, sizeof(v[0]), &v[0].xyz);
-glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(v[0]), &v[0].rgba);
-
-glDrawArrays(GL_TRIANGLES, 0, 3);
-glDisableClientState(GL_VERTEX_ARRAY);
-glDisableClientState(GL_COLOR_ARRAY);
+ batchTri(vertex1, vertex2, vertex3, BATCH_VCOL);
 }
 
 ///////////////////////////////////////////////////////// 
@@ -522,149 +295,21 @@ glDisableClientState(GL_COLOR_ARRAY);
 __inline void PRIMdrawGouraudTri2Color(OGLVertex* vertex1, OGLVertex* vertex2, 
                                        OGLVertex* vertex3, OGLVertex* vertex4) 
 {
-Vertex2 v[4];
-
-v[0].xyz.x = fpoint(vertex1->x);
-v[0].xyz.y = fpoint(vertex1->y);
-v[0].xyz.z = fpoint(vertex1->z);
-v[0].rgba.r = vertex1->c.col[0];
-v[0].rgba.g = vertex1->c.col[1];
-v[0].rgba.b = vertex1->c.col[2];
-v[0].rgba.a = vertex1->c.col[3];
-
-v[1].xyz.x = fpoint(vertex2->x);
-v[1].xyz.y = fpoint(vertex2->y);
-v[1].xyz.z = fpoint(vertex2->z);
-v[1].rgba.r = vertex2->c.col[0];
-v[1].rgba.g = vertex2->c.col[1];
-v[1].rgba.b = vertex2->c.col[2];
-v[1].rgba.a = vertex2->c.col[3];
-
-v[2].xyz.x = fpoint(vertex3->x);
-v[2].xyz.y = fpoint(vertex3->y);
-v[2].xyz.z = fpoint(vertex3->z);
-v[2].rgba.r = vertex3->c.col[0];
-v[2].rgba.g = vertex3->c.col[1];
-v[2].rgba.b = vertex3->c.col[2];
-v[2].rgba.a = vertex3->c.col[3];
-
-v[3].xyz.x = fpoint(vertex4->x);
-v[3].xyz.y = fpoint(vertex4->y);
-v[3].xyz.z = fpoint(vertex4->z);
-v[3].rgba.r = vertex4->c.col[0];
-v[3].rgba.g = vertex4->c.col[1];
-v[3].rgba.b = vertex4->c.col[2];
-v[3].rgba.a = vertex4->c.col[3];
-
-glEnableClientState(GL_VERTEX_ARRAY);
-glEnableClientState(GL_COLOR_ARRAY);
-
-glVertexPointer(3, GL_FLOAT, sizeof(v[0]), &v[0].xyz);
-glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(v[0]), &v[0].rgba);
-
-glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-glDisableClientState(GL_VERTEX_ARRAY);
-glDisableClientState(GL_COLOR_ARRAY);
+ batchQuad(vertex1, vertex2, vertex3, vertex4, BATCH_VCOL);
 }
 
 ///////////////////////////////////////////////////////// 
 
 __inline void PRIMdrawFlatLine(OGLVertex* vertex1, OGLVertex* vertex2,OGLVertex* vertex3, OGLVertex* vertex4)
 {
-Vertex2 v[4];
-
-v[0].xyz.x = fpoint(vertex1->x);
-v[0].xyz.y = fpoint(vertex1->y);
-v[0].xyz.z = fpoint(vertex1->z);
-v[0].rgba.r = vertex1->c.col[0];
-v[0].rgba.g = vertex1->c.col[1];
-v[0].rgba.b = vertex1->c.col[2];
-v[0].rgba.a = vertex1->c.col[3];
-
-v[1].xyz.x = fpoint(vertex2->x);
-v[1].xyz.y = fpoint(vertex2->y);
-v[1].xyz.z = fpoint(vertex2->z);
-v[1].rgba.r = vertex1->c.col[0];
-v[1].rgba.g = vertex1->c.col[1];
-v[1].rgba.b = vertex1->c.col[2];
-v[1].rgba.a = vertex1->c.col[3];
-
-v[2].xyz.x = fpoint(vertex4->x);
-v[2].xyz.y = fpoint(vertex4->y);
-v[2].xyz.z = fpoint(vertex4->z);
-v[2].rgba.r = vertex1->c.col[0];
-v[2].rgba.g = vertex1->c.col[1];
-v[2].rgba.b = vertex1->c.col[2];
-v[2].rgba.a = vertex1->c.col[3];
-
-v[3].xyz.x = fpoint(vertex3->x);
-v[3].xyz.y = fpoint(vertex3->y);
-v[3].xyz.z = fpoint(vertex3->z);
-v[3].rgba.r = vertex1->c.col[0];
-v[3].rgba.g = vertex1->c.col[1];
-v[3].rgba.b = vertex1->c.col[2];
-v[3].rgba.a = vertex1->c.col[3];
-
-glEnableClientState(GL_VERTEX_ARRAY);
-glEnableClientState(GL_COLOR_ARRAY);
-
-glVertexPointer(3, GL_FLOAT, sizeof(v[0]), &v[0].xyz);
-glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(v[0]), &v[0].rgba);
-
-glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-glDisableClientState(GL_VERTEX_ARRAY);
-glDisableClientState(GL_COLOR_ARRAY);
-
-
+ batchQuad(vertex1, vertex2, vertex4, vertex3, BATCH_COL1);
 }
 
 ///////////////////////////////////////////////////////// 
      
 __inline void PRIMdrawGouraudLine(OGLVertex* vertex1, OGLVertex* vertex2,OGLVertex* vertex3, OGLVertex* vertex4)
 {
-	Vertex2 v[4];
-
-v[0].xyz.x = fpoint(vertex1->x);
-v[0].xyz.y = fpoint(vertex1->y);
-v[0].xyz.z = fpoint(vertex1->z);
-v[0].rgba.r = vertex1->c.col[0];
-v[0].rgba.g = vertex1->c.col[1];
-v[0].rgba.b = vertex1->c.col[2];
-v[0].rgba.a = vertex1->c.col[3];
-
-v[1].xyz.x = fpoint(vertex2->x);
-v[1].xyz.y = fpoint(vertex2->y);
-v[1].xyz.z = fpoint(vertex2->z);
-v[1].rgba.r = vertex2->c.col[0];
-v[1].rgba.g = vertex2->c.col[1];
-v[1].rgba.b = vertex2->c.col[2];
-v[1].rgba.a = vertex2->c.col[3];
-
-v[3].xyz.x = fpoint(vertex3->x);
-v[3].xyz.y = fpoint(vertex3->y);
-v[3].xyz.z = fpoint(vertex3->z);
-v[3].rgba.r = vertex3->c.col[0];
-v[3].rgba.g = vertex3->c.col[1];
-v[3].rgba.b = vertex3->c.col[2];
-v[3].rgba.a = vertex3->c.col[3];
-
-v[2].xyz.x = fpoint(vertex4->x);
-v[2].xyz.y = fpoint(vertex4->y);
-v[2].xyz.z = fpoint(vertex4->z);
-v[2].rgba.r = vertex4->c.col[0];
-v[2].rgba.g = vertex4->c.col[1];
-v[2].rgba.b = vertex4->c.col[2];
-v[2].rgba.a = vertex4->c.col[3];
-
-glEnableClientState(GL_VERTEX_ARRAY);
-glEnableClientState(GL_COLOR_ARRAY);
-
-glVertexPointer(3, GL_FLOAT, sizeof(v[0]), &v[0].xyz);
-glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(v[0]), &v[0].rgba);
-
-glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-glDisableClientState(GL_VERTEX_ARRAY);
-glDisableClientState(GL_COLOR_ARRAY);
+ batchQuad(vertex1, vertex2, vertex4, vertex3, BATCH_VCOL);
 }
 
 ///////////////////////////////////////////////////////// 
@@ -672,28 +317,7 @@ glDisableClientState(GL_COLOR_ARRAY);
 __inline void PRIMdrawQuad(OGLVertex* vertex1, OGLVertex* vertex2, 
                            OGLVertex* vertex3, OGLVertex* vertex4) 
 {
-Vec3f v[4];
-
-v[0].x = fpoint(vertex1->x);
-v[0].y = fpoint(vertex1->y);
-v[0].z = fpoint(vertex1->z);
-
-v[1].x = fpoint(vertex2->x);
-v[1].y = fpoint(vertex2->y);
-v[1].z = fpoint(vertex2->z);
-
-v[2].x = fpoint(vertex4->x);
-v[2].y = fpoint(vertex4->y);
-v[2].z = fpoint(vertex4->z);
-
-v[3].x = fpoint(vertex3->x);
-v[3].y = fpoint(vertex3->y);
-v[3].z = fpoint(vertex3->z);
-
-glEnableClientState(GL_VERTEX_ARRAY);
-glVertexPointer(3, GL_FLOAT, sizeof(v[0]), &v[0]);
-glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-glDisableClientState(GL_VERTEX_ARRAY);
+ batchQuad(vertex1, vertex2, vertex4, vertex3, 0);
 }
 
 ////////////////////////////////////////////////////////////////////////                                          
@@ -703,6 +327,24 @@ glDisableClientState(GL_VERTEX_ARRAY);
 static GLenum obm1=GL_ZERO;
 static GLenum obm2=GL_ZERO;
 
+// all blend changes go through these, so a state that is already set
+// (same render state key again, opaque pass after opaque pass) costs
+// nothing but a compare
+static __inline void SetBlendEnable(BOOL b)
+{
+ if(bBlendEnable==b) return;
+ bBlendEnable=b;
+ if(b) glEnable(GL_BLEND);
+ else  glDisable(GL_BLEND);
+}
+
+static __inline void SetBlendFunc(GLenum src,GLenum dst)
+{
+ if(src==obm1 && dst==obm2) return;
+ obm1=src;obm2=dst;
+ glBlendFunc(src,dst);
+}
+
 typedef struct SEMITRANSTAG
 {
  GLenum  srcFac;
@@ -718,6 +360,31 @@ SemiTransParams TransSets[4]=
  {GL_ONE_MINUS_SRC_ALPHA,GL_ONE,      192}
 }; 
 
+typedef struct RENDERSTATETAG
+{
+ GLenum  srcFac;
+ GLenum  dstFac;
+ BOOL    blend;
+ GLubyte alpha;                                        // -> ubGloAlpha
+ GLubyte colAlpha;                                     // -> ubGloColAlpha
+} RenderState_t;
+
+#define RSKEYS 64
+#define RSKEY(multi,pass,tex,semi,abr) \
+ ((((multi)!=0)<<5)|(((pass)!=0)<<4)|(((tex)!=0)<<3)|(((semi)!=0)<<2)|((abr)&3))
+
+static RenderState_t RenderStates[RSKEYS];
+
+static __inline void ApplyRenderState(const RenderState_t * rs)
+{
+ ubGloAlpha=rs->alpha;
+ ubGloColAlpha=rs->colAlpha;
+
+ SetBlendEnable(rs->blend);
+ if(rs->blend)
+  SetBlendFunc(rs->srcFac,rs->dstFac);                 // set blend func
+}
+
 ////////////////////////////////////////////////////////////////////////
 
 void SetSemiTrans(void)
@@ -729,45 +396,7 @@ void SetSemiTrans(void)
 * 1.0 x B +0.25 x F
 */
 
- if(!DrawSemiTrans)                                    // no semi trans at all?
-  {
-   if(bBlendEnable)
-    {glDisable(GL_BLEND);bBlendEnable=FALSE;}          // -> don't wanna blend
-   ubGloAlpha=ubGloColAlpha=255;                       // -> full alpha
-   return;                                             // -> and bye
-  }
-
- ubGloAlpha=ubGloColAlpha=TransSets[GlobalTextABR].alpha;
-
- if(!bBlendEnable)
-  {glEnable(GL_BLEND);bBlendEnable=TRUE;}              // wanna blend
-
- if(TransSets[GlobalTextABR].srcFac!=obm1 || 
-    TransSets[GlobalTextABR].dstFac!=obm2)
-  {
-   //if(glBlendEquationEXTEx==NULL)
-    {
-     obm1=TransSets[GlobalTextABR].srcFac;
-     obm2=TransSets[GlobalTextABR].dstFac;
-     glBlendFunc(obm1,obm2);                           // set blend func
-    }
-   /*else
-   if(TransSets[GlobalTextABR].dstFac !=GL_ONE_MINUS_SRC_COLOR)
-    {
-     if(obm2==GL_ONE_MINUS_SRC_COLOR)
-      glBlendEquationEXTEx(FUNC_ADD_EXT);
-     obm1=TransSets[GlobalTextABR].srcFac;
-     obm2=TransSets[GlobalTextABR].dstFac;
-     glBlendFunc(obm1,obm2);                           // set blend func
-    }
-   else
-    {
-     glBlendEquationEXTEx(FUNC_REVERSESUBTRACT_EXT);
-     obm1=TransSets[GlobalTextABR].srcFac;
-     obm2=TransSets[GlobalTextABR].dstFac;
-     glBlendFunc(GL_ONE,GL_ONE);                       // set blend func
-    }*/
-  }
+ ApplyRenderState(&RenderStates[RSKEY(0,0,0,DrawSemiTrans,GlobalTextABR)]);
 }
 
 void SetScanTrans(void)                                // blending for scan lines
@@ -778,9 +407,7 @@ void SetScanTrans(void)                                // blending for scan line
     glBlendEquationEXTEx(FUNC_ADD_EXT);
   }
 */
- obm1=TransSets[0].srcFac;
- obm2=TransSets[0].dstFac;
- glBlendFunc(obm1,obm2);                               // set blend func
+ SetBlendFunc(TransSets[0].srcFac,TransSets[0].dstFac); // set blend func
 }
 
 void SetScanTexTrans(void)                             // blending for scan mask texture
@@ -791,9 +418,7 @@ void SetScanTexTrans(void)                             // blending for scan mask
     glBlendEquationEXTEx(FUNC_ADD_EXT);
   }
 */
- obm1=TransSets[2].srcFac;
- obm2=TransSets[2].dstFac;
- glBlendFunc(obm1,obm2);                               // set blend func
+ SetBlendFunc(TransSets[2].srcFac,TransSets[2].dstFac); // set blend func
 }
 
 ////////////////////////////////////////////////////////////////////////                                          
@@ -834,52 +459,57 @@ SemiTransParams MultiColTransSets[4]=
 
 void SetSemiTransMulti(int Pass)
 {
- static GLenum bm1=GL_ZERO;
- static GLenum bm2=GL_ONE;
+ ApplyRenderState(&RenderStates[RSKEY(1,Pass,bDrawTextured,DrawSemiTrans,GlobalTextABR)]);
+}
 
- ubGloAlpha=255;
- ubGloColAlpha=255;
- 
- // are we enabling SemiTransparent mode?
- if(DrawSemiTrans)
+////////////////////////////////////////////////////////////////////////                                          
+// Prebuilt blend states: every combination of semi trans mode, multi
+// pass, pass and texturing gets its GL state computed once, so prims
+// only have to pick a key and apply what differs from the current state
+////////////////////////////////////////////////////////////////////////                                          
+
+void InitRenderStates(void)
+{
+ int key,multi,pass,tex,semi,abr;
+ RenderState_t * rs;
+
+ for(key=0;key<RSKEYS;key++)
   {
-   if(bDrawTextured)
-    {
-     bm1=MultiTexTransSets[GlobalTextABR][Pass].srcFac;
-     bm2=MultiTexTransSets[GlobalTextABR][Pass].dstFac;
-     ubGloAlpha=MultiTexTransSets[GlobalTextABR][Pass].alpha;
-    }
-   // no texture
-   else
+   rs=&RenderStates[key];
+   multi=(key>>5)&1;pass=(key>>4)&1;tex=(key>>3)&1;
+   semi=(key>>2)&1;abr=key&3;
+
+   rs->blend=TRUE;
+   rs->alpha=rs->colAlpha=255;
+
+   if(!multi)                                          // simple blending
     {
-     bm1=MultiColTransSets[GlobalTextABR].srcFac;
-     bm2=MultiColTransSets[GlobalTextABR].dstFac;
-     ubGloColAlpha=MultiColTransSets[GlobalTextABR].alpha;
+     if(!semi) {rs->blend=FALSE;rs->srcFac=GL_ONE;rs->dstFac=GL_ZERO;continue;}
+     rs->srcFac=TransSets[abr].srcFac;
+     rs->dstFac=TransSets[abr].dstFac;
+     rs->alpha=rs->colAlpha=TransSets[abr].alpha;
     }
-  }
- // no shading
- else
-  {
-   if(Pass==0)
+   else if(semi)                                       // 'advanced' multi pass
     {
-     // disable blending
-     bm1=GL_ONE;bm2=GL_ZERO;
+     if(tex)
+      {
+       rs->srcFac=MultiTexTransSets[abr][pass].srcFac;
+       rs->dstFac=MultiTexTransSets[abr][pass].dstFac;
+       rs->alpha=MultiTexTransSets[abr][pass].alpha;
+      }
+     else
+      {
+       rs->srcFac=MultiColTransSets[abr].srcFac;
+       rs->dstFac=MultiColTransSets[abr].dstFac;
+       rs->colAlpha=MultiColTransSets[abr].alpha;
+      }
     }
-   else
-    {
-     // disable blending, but add src col a second time
-     bm1=GL_ONE;bm2=GL_ONE;
+   else                                                // no semi trans: pass 0
+    {                                                  // plain, pass 1 adds
+     rs->srcFac=GL_ONE;                                // src col a second time
+     rs->dstFac=pass?GL_ONE:GL_ZERO;
     }
   }
-
- if(!bBlendEnable)
-  {glEnable(GL_BLEND);bBlendEnable=TRUE;}              // wanna blend
-
- if(bm1!=obm1 || bm2!=obm2)
-  {
-   glBlendFunc(bm1,bm2);                               // set blend func
-   obm1=bm1;obm2=bm2;
-  }
 }
 
 ////////////////////////////////////////////////////////////////////////                                          
@@ -1526,8 +1156,7 @@ void UploadScreenEx(long Position)
  glDisable(GL_SCISSOR_TEST);
  glShadeModel(GL_FLAT);
  bOldSmoothShaded=FALSE;
- glDisable(GL_BLEND);
- bBlendEnable=FALSE;
+ SetBlendEnable(FALSE);
  glDisable(GL_TEXTURE_2D);
  bTexEnabled=FALSE;
  glDisable(GL_ALPHA_TEST);
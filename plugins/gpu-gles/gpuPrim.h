@@ -48,6 +48,7 @@ BOOL FastCheckAgainstFrontScreen(short imageX0,short imageY0,short imageX1,short
 BOOL bCheckFF9G4(u8 * baseAddr);
 void SetScanTrans(void);
 void SetScanTexTrans(void);
+void InitRenderStates(void);
 void DrawMultiBlur(void);
 void CheckWriteUpdate();
 
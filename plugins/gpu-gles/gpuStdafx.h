@@ -89,6 +89,10 @@ extern "C" {
 
 #define __inline inline
 
+#ifndef __NANOGL__
+#include "gpuBatch.h"
+#endif
+
 #endif
 
 #define SHADETEXBIT(x) ((x>>24) & 0x1)
@@ -178,11 +178,17 @@ typedef struct textureWndCacheEntryTag
  short          pageid;
  short          textureMode;
  short          Opaque;
- short          used;
+ short          used;                                  // 0: free, 1: valid, 2: vram written
  EXLong         pos;
  GLuint         texname;
+ unsigned long  hash;                                  // texel + clut content hash
+ unsigned long  lastuse;                               // LRU tick
+ short          x0,y0,x1,y1;                           // vram area the texture got built from
+ short          cx0,cx1,cy;                            // clut area (cy<0: none)
 } textureWndCacheEntry;
 
+#define TWND_DIRTY 2
+
 // "standard texture" cache entry (12 byte per entry, as small as possible... we need lots of them)
 
 typedef struct textureSubCacheEntryTagS 
@@ -214,8 +220,10 @@ GLuint                   uiStexturePage[MAXSORTTEX_MAX];
 unsigned short           usLRUTexPage=0;
 
 int                      iMaxTexWnds=0;
-int                      iTexWndTurn=0;
 int                      iTexWndLimit=MAXWNDTEXCACHE/2;
+unsigned long            ulTexWndTick=0;
+
+TexCacheStats_t          texCacheStats;
 
 GLubyte *                texturepart=NULL;
 GLubyte *                texturebuffer=NULL;
@@ -562,6 +570,8 @@ void InitializeTextureStore()
 
  memset(wcWndtexStore,0,sizeof(textureWndCacheEntry)*
                         MAXWNDTEXCACHE);
+ ulTexWndTick=0;
+ memset(&texCacheStats,0,sizeof(texCacheStats));
  texturepart=(GLubyte *)malloc(256*256*4);
  memset(texturepart,0,256*256*4);
 	 texturebuffer=NULL;
@@ -588,6 +598,12 @@ void CleanupTextureStore()
 {
  int i,j;textureWndCacheEntry * tsx;
  //----------------------------------------------------//
+#ifdef TEXCACHE_STATS
+ printf("texcache: %lu hits, %lu misses, %lu rehashed, %lu evicted, %lu KiB uploaded\n",
+        texCacheStats.hits,texCacheStats.misses,texCacheStats.rehashed,
+        texCacheStats.evictions,texCacheStats.uploadbytes>>10);
+#endif
+ //----------------------------------------------------//
  glBindTexture(GL_TEXTURE_2D,0);
  //----------------------------------------------------//
  free(texturepart);                                    // free tex part
@@ -689,7 +705,7 @@ void ResetTextureArea(BOOL bDelTex)
 
 void InvalidateWndTextureArea(long X,long Y,long W, long H)
 {
- int i,px1,px2,py1,py2,iYM=1;
+ int i;
  textureWndCacheEntry * tsw=wcWndtexStore;
 
  W+=X-1;      
@@ -698,52 +714,71 @@ void InvalidateWndTextureArea(long X,long Y,long W, long H)
  if(W<0) W=0;if(W>1023) W=1023;
  if(Y<0) Y=0;if(Y>iGPUHeightMask)  Y=iGPUHeightMask;
  if(H<0) H=0;if(H>iGPUHeightMask)  H=iGPUHeightMask;
- W++;H++;
 
- if(iGPUHeight==1024) iYM=3;
+ // only windows really built from the written rect are affected, and
+ // those are just marked: the content hash decides on next use if
+ // they have to be uploaded again
+ for(i=0;i<iMaxTexWnds;i++,tsw++)
+  {
+   if(tsw->used!=1) continue;
+   if(tsw->x0<=W && tsw->x1>=X && tsw->y0<=H && tsw->y1>=Y)
+    tsw->used=TWND_DIRTY;
+   else if(tsw->cy>=Y && tsw->cy<=H && tsw->cx0<=W && tsw->cx1>=X)
+    tsw->used=TWND_DIRTY;
+  }
+}
 
- py1=min(iYM,Y>>8);
- py2=min(iYM,H>>8);                                    // y: 0 or 1
+////////////////////////////////////////////////////////////////////////
+// tex window: vram area and content hash
+////////////////////////////////////////////////////////////////////////
 
- px1=max(0,(X>>6));
- px2=min(15,(W>>6));
+static void GetWndTextureArea(textureWndCacheEntry * ts,short cx,short cy)
+{
+ int bx=(ts->pageid&15)<<6;
+ int by=(ts->pageid>>4)<<8;
+ int sh=2-ts->textureMode;                             // texels per vram word: 4/2/1
 
- if(py1==py2)
+ if(GlobalTextIL)                                      // interleaved: take the whole page
   {
-   py1=py1<<4;px1+=py1;px2+=py1;                       // change to 0-31
-   for(i=0;i<iMaxTexWnds;i++,tsw++)
-    {
-     if(tsw->used)
-      {
-       if(tsw->pageid>=px1 && tsw->pageid<=px2)
-        {
-         tsw->used=0;
-        }
-      }
-    }
+   ts->x0=bx;ts->x1=bx+255;
+   ts->y0=by;ts->y1=by+255;
   }
  else
   {
-   py1=px1+16;py2=px2+16;
-   for(i=0;i<iMaxTexWnds;i++,tsw++)
-    {
-     if(tsw->used)
-      {
-       if((tsw->pageid>=px1 && tsw->pageid<=px2) ||
-          (tsw->pageid>=py1 && tsw->pageid<=py2))
-        {
-         tsw->used=0;
-        }
-      }
-    }
+   ts->x0=bx+(g_x1>>sh);ts->x1=bx+(g_x2>>sh);
+   ts->y0=by+g_y1;      ts->y1=by+g_y2;
   }
+ if(ts->x1>1023)           ts->x1=1023;
+ if(ts->y1>iGPUHeightMask) ts->y1=iGPUHeightMask;
 
- // adjust tex window count
- tsw=wcWndtexStore+iMaxTexWnds-1;
- while(iMaxTexWnds && !tsw->used) {iMaxTexWnds--;tsw--;}
+ if(ts->textureMode==2) {ts->cx0=ts->cx1=0;ts->cy=-1;}
+ else
+  {
+   ts->cx0=cx;ts->cx1=cx+(ts->textureMode?255:15);
+   if(ts->cx1>1023) ts->cx1=1023;
+   ts->cy=cy;
+  }
 }
 
+static unsigned long HashWndTexture(textureWndCacheEntry * ts)
+{
+ unsigned long h=2166136261UL;                         // FNV-1a on vram words
+ unsigned short * p;int x,y;
 
+ for(y=ts->y0;y<=ts->y1;y++)
+  {
+   p=psxVuw+(y<<10)+ts->x0;
+   for(x=ts->x0;x<=ts->x1;x++)
+    h=(h^*p++)*16777619UL;
+  }
+ if(ts->cy>=0)
+  {
+   p=psxVuw+(ts->cy<<10)+ts->cx0;
+   for(x=ts->cx0;x<=ts->cx1;x++)
+    h=(h^*p++)*16777619UL;
+  }
+ return h;
+}
 
 ////////////////////////////////////////////////////////////////////////
 // same for sort textures
@@ -915,6 +950,7 @@ void DefineTextureWnd(void)
               TWin.Position.x1, 
               TWin.Position.y1, 
               0, GL_RGBA, GL_UNSIGNED_BYTE, texturepart);
+ texCacheStats.uploadbytes+=TWin.Position.x1*TWin.Position.y1*4;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1672,6 +1708,7 @@ void DefinePalTextureWnd(void)
               TWin.Position.x1, 
               TWin.Position.y1, 
               0, GL_RGBA, GL_UNSIGNED_BYTE,texturepart);
+ texCacheStats.uploadbytes+=TWin.Position.x1*TWin.Position.y1*4;
 }
 
 ///////////////////////////////////////////////////////
@@ -1849,6 +1886,7 @@ GLuint LoadTextureWnd(long pageid,long TextureMode,unsigned long GivenClutId)
   }
 
  ts=wcWndtexStore;
+ ulTexWndTick++;
 
  for(i=0;i<iMaxTexWnds;i++,ts++)
   {
@@ -1856,25 +1894,40 @@ GLuint LoadTextureWnd(long pageid,long TextureMode,unsigned long GivenClutId)
     {
      if(ts->pos.l==npos.l &&
         ts->pageid==pageid &&
-        ts->textureMode==TextureMode)
+        ts->textureMode==TextureMode &&
+        ts->ClutID==GivenClutId)
       {
-       if(ts->ClutID==GivenClutId)
+       if(ts->used==TWND_DIRTY)                        // vram got written: same data?
         {
-         ubOpaqueDraw=ts->Opaque;
-         return ts->texname;
+         if(ts->hash!=HashWndTexture(ts))
+          {ts->used=0;tsx=ts;break;}                   // no, rebuild in this slot
+         ts->used=1;
+         texCacheStats.rehashed++;
         }
+       texCacheStats.hits++;
+       ts->lastuse=ulTexWndTick;
+       ubOpaqueDraw=ts->Opaque;
+       return ts->texname;
       }
     }
    else tsx=ts;
   }
 
+ texCacheStats.misses++;
+
  if(!tsx) 
   {
-   if(iMaxTexWnds==iTexWndLimit)
-    {
-     tsx=wcWndtexStore+iTexWndTurn;
-     iTexWndTurn++; 
-     if(iTexWndTurn==iTexWndLimit) iTexWndTurn=0;
+   if(iMaxTexWnds==iTexWndLimit)                       // full: drop least recently used,
+    {                                                  // stale ones first
+     unsigned long age,maxage=0;
+     tsx=ts=wcWndtexStore;
+     for(i=0;i<iMaxTexWnds;i++,ts++)
+      {
+       age=ulTexWndTick-ts->lastuse;
+       if(ts->used==TWND_DIRTY) age|=0x80000000;
+       if(age>maxage) {maxage=age;tsx=ts;}
+      }
+     texCacheStats.evictions++;
     }
    else
     {
@@ -1902,6 +1955,9 @@ GLuint LoadTextureWnd(long pageid,long TextureMode,unsigned long GivenClutId)
  tsx->textureMode=TextureMode;
  tsx->texname=gTexName;
  tsx->used=1;
+ tsx->lastuse=ulTexWndTick;
+ GetWndTextureArea(tsx,cx,cy);
+ tsx->hash=HashWndTexture(tsx);
        
  return gTexName;
 }
@@ -3456,6 +3512,7 @@ void DefineSubTextureSortHiRes(void)
  glTexSubImage2D(GL_TEXTURE_2D, 0, XTexS<<1, YTexS<<1,
                  DXTexS<<1, DYTexS<<1,
                  GL_RGBA, GL_UNSIGNED_BYTE, texturebuffer);
+ texCacheStats.uploadbytes+=DXTexS*DYTexS*16;
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -3488,6 +3545,7 @@ void DefineSubTextureSort(void)
  glTexSubImage2D(GL_TEXTURE_2D, 0, XTexS, YTexS,
                  DXTexS, DYTexS,
                  GL_RGBA, GL_UNSIGNED_BYTE, texturepart);
+ texCacheStats.uploadbytes+=DXTexS*DYTexS*4;
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -4192,9 +4250,10 @@ GLuint SelectSubTextureS(long TextureMode, unsigned long GivenClutId)
 
  // found? fine
  usLRUTexPage=iCache;
- if(!OPtr) return uiStexturePage[iCache];
+ if(!OPtr) {texCacheStats.hits++;return uiStexturePage[iCache];}
 
  // not found? upload texture and store infos in cache
+ texCacheStats.misses++;
  gTexName=uiStexturePage[iCache];
  LoadSubTexFn(GlobalTexturePage,TextureMode,cx,cy);
  uiStexturePage[iCache]=gTexName;
@@ -34,6 +34,17 @@ extern "C" {
 
 #define TEXTUREPAGESIZE 256*256
 
+typedef struct TEXCACHESTATSTAG
+{
+ unsigned long hits;
+ unsigned long misses;
+ unsigned long rehashed;                               // vram written, but content unchanged
+ unsigned long evictions;
+ unsigned long uploadbytes;
+} TexCacheStats_t;
+
+extern TexCacheStats_t texCacheStats;
+
 void           InitializeTextureStore();
 void           CleanupTextureStore();
 GLuint         LoadTextureWnd(long pageid,long TextureMode,unsigned long GivenClutId);
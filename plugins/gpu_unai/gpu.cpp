@@ -22,6 +22,7 @@
 #include "gpu.h"
 #include "profiler.h"
 #include "debug.h"
+#include "../../frontend/blit_dirty.h"
 
 int skipCount = 2; /* frame skip (0,1,2,3...) */
 int skCount=0; /* internal frame skip */
@@ -41,6 +42,7 @@ bool light = true; /* lighting */
 bool blend = true; /* blending */
 
 bool fb_dirty = false;
+struct blit_dirty vram_dirty; /* per-line changes for the blitter */
 
 bool enableAbbeyHack = false; /* Abe's Odyssey hack */
 u8 BLEND_MODE;
@@ -154,6 +156,8 @@ INLINE void gpuReset(void)
 bool  GPU_init(void)
 {
 	gpuReset();
+	blit_dirty_invalidate(&vram_dirty);
+	blit_dirty_mark_all(&vram_dirty);
 	
 	// s_invTable
 	for(int i=1;i<=(1<<TABLE_BITS);++i)
@@ -198,6 +202,7 @@ long  GPU_freeze(unsigned int bWrite, GPUFreeze_t* p2)
 	{
 		GPU_GP1 = p2->GPU_gp1;
 		memcpy((u16*)GPU_FrameBuffer, p2->FrameBuffer, FRAME_BUFFER_SIZE);
+		blit_dirty_mark_all(&vram_dirty);
 		GPU_writeStatus((5 << 24) | p2->Control[5]);
 		GPU_writeStatus((7 << 24) | p2->Control[7]);
 		GPU_writeStatus((8 << 24) | p2->Control[8]);
@@ -257,6 +262,22 @@ INLINE void gpuCheckPacket(u32 uData)
 	if (!PacketCount) gpuSendPacket();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//  During frame skip whole draw packets are dropped right from the source
+//  buffer, only textured polys still update the texture page.
+//  Returns words consumed, 0 if the packet needs normal processing.
+INLINE s32 gpuSkipPacket(const u32 *packet, s32 count)
+{
+	const u32 cmd = packet[0] >> 24;
+	const s32 len = PacketSize[cmd] + 1;
+
+	if (cmd < 0x20 || cmd >= 0x80 || (cmd & 0xE8) == 0x48 || len > count)
+		return 0;
+	if (cmd < 0x40 && (cmd & 0x24) == 0x24)
+		GPU_GP1 = (GPU_GP1 & ~0x7FF) | ((packet[(cmd & 0x10) ? 5 : 4] >> 16) & 0x7FF);
+	return len;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void  GPU_writeDataMem(u32* dmaAddress, s32 dmaCount)
 {
@@ -306,6 +327,13 @@ void  GPU_writeDataMem(u32* dmaAddress, s32 dmaCount)
 		}
 		else
 		{
+			s32 len;
+			if (isSkip && !PacketCount && (len = gpuSkipPacket(dmaAddress, dmaCount)))
+			{
+				dmaAddress += len;
+				dmaCount -= len;
+				continue;
+			}
 			data = *dmaAddress++;
 			dmaCount--;
 			gpuCheckPacket(data);
@@ -876,6 +904,9 @@ static void blit(void)
 	static s16 old_res_horz, old_res_vert, old_rgb24;
 	s16 isRGB24 = (GPU_GP1 & 0x00200000) ? 1 : 0;
 	s16 h0, x0, y0, w0, h1;
+	struct blit_dirty_layout layout;
+	unsigned int since;
+	int y, hud_y;
 	u16 *srcs;
 	u8  *dest;
 
@@ -898,31 +929,43 @@ static void blit(void)
 		old_res_vert = h1;
 		old_rgb24 = (s16)isRGB24;
 		screen_buf = cbs->pl_fbdev_set_mode(w0, h1, isRGB24 ? 24 : 16);
+		blit_dirty_invalidate(&vram_dirty);
 	}
 	dest = (u8 *)screen_buf;
 
+	layout.x = x0; layout.y = y0;
+	layout.w = w0; layout.h = h1;
+	layout.bpp = isRGB24 ? 24 : 16;
+	layout.ofs = 0;
+	since = blit_dirty_begin(&vram_dirty, screen_buf, &layout);
+	hud_y = h1 - PL_HUD_LINES; // frontend may have drawn text there
+
 	if (isRGB24)
 	{
 #ifndef MAEMO
-		for (; h1-- > 0; dest += w0 * 3, srcs += 1024)
+		for (y = 0; y < h1; y++, dest += w0 * 3, srcs += 1024)
 		{
-			bgr888_to_rgb888(dest, srcs, w0 * 3);
+			if (blit_dirty_line(&vram_dirty, since, y0 + y) || y >= hud_y)
+				bgr888_to_rgb888(dest, srcs, w0 * 3);
 		}
 #else
-		for (; h1-- > 0; dest += w0 * 2, srcs += 1024)
+		for (y = 0; y < h1; y++, dest += w0 * 2, srcs += 1024)
 		{
-			bgr888_to_rgb565(dest, srcs, w0 * 3);
+			if (blit_dirty_line(&vram_dirty, since, y0 + y) || y >= hud_y)
+				bgr888_to_rgb565(dest, srcs, w0 * 3);
 		}
 #endif
 	}
 	else
 	{
-		for (; h1-- > 0; dest += w0 * 2, srcs += 1024)
+		for (y = 0; y < h1; y++, dest += w0 * 2, srcs += 1024)
 		{
-			bgr555_to_rgb565(dest, srcs, w0 * 2);
+			if (blit_dirty_line(&vram_dirty, since, y0 + y) || y >= hud_y)
+				bgr555_to_rgb565(dest, srcs, w0 * 2);
 		}
 	}
 
+	blit_dirty_end(&vram_dirty, screen_buf, &layout);
 	screen_buf = cbs->pl_fbdev_flip();
 }
 
@@ -949,6 +992,7 @@ long GPUopen(unsigned long *, char *, char *)
 {
 	cbs->pl_fbdev_open();
 	screen_buf = cbs->pl_fbdev_flip();
+	blit_dirty_invalidate(&vram_dirty);
 	return 0;
 }
 
@@ -60,6 +60,15 @@ INLINE void gpuSetCLUT(u16 clut)
 #define DO_LOG(expr) {}
 #endif
 
+#ifndef REARMED
+//  drawing environment changes usually start a new frame
+#define DRAWENV_UNSKIP() isSkip = false
+#else
+//  frontend decides skipping at vsync, games set the environment every
+//  frame so letting it cancel the skip would never skip anything
+#define DRAWENV_UNSKIP()
+#endif
+
 #define Blending (((PRIM&0x2)&&(blend))?(PRIM&0x2):0)
 #define Blending_Mode (((PRIM&0x2)&&(blend))?BLEND_MODE:0)
 #define Lighting (((~PRIM)&0x1)&&(light))
@@ -68,6 +77,10 @@ void gpuSendPacketFunction(const int PRIM)
 {
 	//printf("0x%x\n",PRIM);
 
+	// drawing prims can't leave the drawing area
+	if (PRIM >= 0x20 && PRIM < 0x80 && !isSkip)
+		blit_dirty_draw(&vram_dirty, DrawingArea[1], DrawingArea[3] - 1);
+
 	switch (PRIM)
 	{
 		case 0x02:
@@ -400,7 +413,7 @@ void gpuSendPacketFunction(const int PRIM)
 				TextureWindow[2] = TextureMask[(temp >> 0) & 0x1F];
 				TextureWindow[3] = TextureMask[(temp >> 5) & 0x1F];
 				gpuSetTexture(GPU_GP1);
-				isSkip = false;
+				DRAWENV_UNSKIP();
 				DO_LOG(("TextureWindow(0x%x)\n",PRIM));
 			}
 			break;
@@ -409,7 +422,7 @@ void gpuSendPacketFunction(const int PRIM)
 				const u32 temp = PacketBuffer.U4[0];
 				DrawingArea[0] = temp         & 0x3FF;
 				DrawingArea[1] = (temp >> 10) & 0x3FF;
-				isSkip = false;
+				DRAWENV_UNSKIP();
 				DO_LOG(("DrawingArea_Pos(0x%x)\n",PRIM));
 			}
 			break;
@@ -418,7 +431,7 @@ void gpuSendPacketFunction(const int PRIM)
 				const u32 temp = PacketBuffer.U4[0];
 				DrawingArea[2] = (temp         & 0x3FF) + 1;
 				DrawingArea[3] = ((temp >> 10) & 0x3FF) + 1;
-				isSkip = false;
+				DRAWENV_UNSKIP();
 				DO_LOG(("DrawingArea_Size(0x%x)\n",PRIM));
 			}
 			break;
@@ -427,7 +440,7 @@ void gpuSendPacketFunction(const int PRIM)
 				const u32 temp = PacketBuffer.U4[0];
 				DrawingOffset[0] = ((long)temp<<(32-11))>>(32-11);
 				DrawingOffset[1] = ((long)temp<<(32-22))>>(32-11);
-				isSkip = false;
+				DRAWENV_UNSKIP();
 				DO_LOG(("DrawingOffset(0x%x)\n",PRIM));
 			}
 			break;
@@ -33,6 +33,7 @@ INLINE void gpuLoadImage(void)
 	}
 
 	FrameToWrite = ((w0)&&(h0));
+	blit_dirty_mark(&vram_dirty, y0, h0);
 
 	px = 0;
 	py = 0;
@@ -80,6 +81,7 @@ INLINE void gpuMoveImage(void)
 
 	if( (x0==x1) && (y0==y1) ) return;
 	if ((w0<=0) || (h0<=0)) return;
+	blit_dirty_mark(&vram_dirty, y1, h0);
 	
 	if (((y0+h0)>512)||((x0+w0)>1024)||((y1+h0)>512)||((x1+w0)>1024))
 	{
@@ -161,6 +163,7 @@ INLINE void gpuClearImage(void)
 	if (h0 > FRAME_HEIGHT) h0 = FRAME_HEIGHT;
 	h0 -= y0;
 	if (h0 <= 0) return;
+	blit_dirty_mark(&vram_dirty, y0, h0);
 
 	if (x0&1)
 	{
@@ -0,0 +1,192 @@
+/*
+ * (C) notaz, 2011
+ *
+ * This work is licensed under the terms of the GNU GPLv2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+/*
+ * replays a GPU recording through two GPU plugins (or two builds of one,
+ * copied to different filenames) and compares VRAM after every frame.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "grec.h"
+
+struct diff_stats {
+	int pixels;
+	int x0, y0, x1, y1;	// bounding box, inclusive
+	int max_delta;		// biggest per-channel difference, 0-31
+};
+
+static void usage(const char *argv0)
+{
+	printf("usage:\n%s [-d dir] [-m max_dumps] <a.so> <b.so> <recording>\n"
+		"  -d  write VRAM diff images of mismatching frames to dir\n"
+		"  -m  stop dumping after this many images (default 16)\n", argv0);
+	exit(1);
+}
+
+static int ch_delta(int a, int b)
+{
+	return a > b ? a - b : b - a;
+}
+
+static void diff_vram(const uint16_t *a, const uint16_t *b,
+	struct diff_stats *s)
+{
+	int x, y, d;
+
+	memset(s, 0, sizeof(*s));
+	s->x0 = 1024; s->y0 = 512;
+	s->x1 = s->y1 = -1;
+
+	for (y = 0; y < 512; y++, a += 1024, b += 1024) {
+		if (memcmp(a, b, 1024 * 2) == 0)
+			continue;
+		for (x = 0; x < 1024; x++) {
+			if (a[x] == b[x])
+				continue;
+			s->pixels++;
+			if (x < s->x0) s->x0 = x;
+			if (x > s->x1) s->x1 = x;
+			if (y < s->y0) s->y0 = y;
+			if (y > s->y1) s->y1 = y;
+			d = ch_delta(a[x] & 0x1f, b[x] & 0x1f);
+			if (d > s->max_delta) s->max_delta = d;
+			d = ch_delta((a[x] >> 5) & 0x1f, (b[x] >> 5) & 0x1f);
+			if (d > s->max_delta) s->max_delta = d;
+			d = ch_delta((a[x] >> 10) & 0x1f, (b[x] >> 10) & 0x1f);
+			if (d > s->max_delta) s->max_delta = d;
+		}
+	}
+}
+
+/* a on the left, b in the middle, differences on the right */
+static int dump_diff(const char *dir, int frame,
+	const uint16_t *a, const uint16_t *b)
+{
+	static unsigned char line[1024 * 3 * 3];
+	const uint16_t *src[2] = { a, b };
+	unsigned char *d;
+	char fname[512];
+	FILE *f;
+	int i, x, y;
+
+	snprintf(fname, sizeof(fname), "%s/diff_%05d.ppm", dir, frame);
+	f = fopen(fname, "wb");
+	if (f == NULL) {
+		perror(fname);
+		return -1;
+	}
+
+	fprintf(f, "P6\n%d %d\n255\n", 1024 * 3, 512);
+	for (y = 0; y < 512; y++, a += 1024, b += 1024) {
+		src[0] = a; src[1] = b;
+		d = line;
+		for (i = 0; i < 2; i++) {
+			for (x = 0; x < 1024; x++, d += 3) {
+				uint16_t p = src[i][x];
+				d[0] = (p << 3) & 0xf8;
+				d[1] = (p >> 2) & 0xf8;
+				d[2] = (p >> 7) & 0xf8;
+			}
+		}
+		for (x = 0; x < 1024; x++, d += 3) {
+			if (a[x] != b[x]) {
+				d[0] = 0xff; d[1] = d[2] = 0;
+			}
+			else {
+				// dimmed grey so the picture is still recognizable
+				d[0] = d[1] = d[2] = (((a[x] >> 5) & 0x1f) << 1) + 0x20;
+			}
+		}
+		fwrite(line, 1, sizeof(line), f);
+	}
+
+	fclose(f);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct grec_freeze *fa, *fb;
+	struct gpu_plugin pa, pb;
+	struct diff_stats s;
+	struct grec rec;
+	const char *dump_dir = NULL;
+	int max_dumps = 16, dumps = 0;
+	int frame = 0, bad_frames = 0, first_bad = -1;
+	int i, arg = 1;
+
+	for (; arg < argc - 1 && argv[arg][0] == '-'; arg += 2) {
+		if (strcmp(argv[arg], "-d") == 0)
+			dump_dir = argv[arg + 1];
+		else if (strcmp(argv[arg], "-m") == 0)
+			max_dumps = atoi(argv[arg + 1]);
+		else
+			usage(argv[0]);
+	}
+	if (argc != arg + 3)
+		usage(argv[0]);
+
+	fa = malloc(sizeof(*fa));
+	fb = malloc(sizeof(*fb));
+	if (fa == NULL || fb == NULL) {
+		fprintf(stderr, "OOM\n");
+		return 1;
+	}
+
+	if (grec_load(&rec, argv[arg + 2]) != 0)
+		return 1;
+	if (gpu_plugin_load(&pa, argv[arg]) != 0)
+		return 1;
+	if (gpu_plugin_load(&pb, argv[arg + 1]) != 0)
+		return 1;
+	if (pa.handle == pb.handle) {
+		fprintf(stderr, "same plugin loaded twice, copy it to another name\n");
+		return 1;
+	}
+
+	for (i = 0; i < rec.rec_count; i++) {
+		grec_play(&pa, &rec.recs[i]);
+		grec_play(&pb, &rec.recs[i]);
+		if (rec.recs[i].type != GREC_VSYNC)
+			continue;
+
+		fa->version = fb->version = 1;
+		pa.freeze(1, fa);
+		pb.freeze(1, fb);
+		diff_vram((uint16_t *)fa->vram, (uint16_t *)fb->vram, &s);
+		if (s.pixels > 0) {
+			printf("frame %5d: %6d pixels differ, area %d,%d-%d,%d, "
+				"max delta %d\n", frame, s.pixels, s.x0, s.y0,
+				s.x1, s.y1, s.max_delta);
+			if (first_bad < 0)
+				first_bad = frame;
+			bad_frames++;
+			if (dump_dir != NULL && dumps < max_dumps) {
+				if (dump_diff(dump_dir, frame, (uint16_t *)fa->vram,
+						(uint16_t *)fb->vram) == 0)
+					dumps++;
+			}
+		}
+		frame++;
+	}
+
+	printf("%d frames, %d differ", frame, bad_frames);
+	if (first_bad >= 0)
+		printf(", first at %d", first_bad);
+	printf("\n");
+
+	gpu_plugin_unload(&pb);
+	gpu_plugin_unload(&pa);
+	grec_free(&rec);
+	free(fa);
+	free(fb);
+
+	return bad_frames ? 2 : 0;
+}
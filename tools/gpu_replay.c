@@ -0,0 +1,79 @@
+/*
+ * (C) notaz, 2011
+ *
+ * This work is licensed under the terms of the GNU GPLv2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+/*
+ * replays a GPU recording (made with pcsx -gpurec) through a GPU plugin
+ * and reports timing, without the CPU, SPU or frontend getting in the way.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "grec.h"
+
+static void usage(const char *argv0)
+{
+	printf("usage:\n%s [-n loops] <plugin.so> <recording>\n", argv0);
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	double t, t_frame, t_total = 0, t_min = 1e9, t_max = 0;
+	struct gpu_plugin plugin;
+	struct grec rec;
+	int loops = 1, frames = 0;
+	int i, l, arg = 1;
+
+	if (argc > arg + 1 && strcmp(argv[arg], "-n") == 0) {
+		loops = atoi(argv[arg + 1]);
+		arg += 2;
+	}
+	if (argc != arg + 2 || loops < 1)
+		usage(argv[0]);
+
+	if (grec_load(&rec, argv[arg + 1]) != 0)
+		return 1;
+	if (gpu_plugin_load(&plugin, argv[arg]) != 0)
+		return 1;
+
+	printf("%d records, %d frames, %u primitives\n",
+		rec.rec_count, rec.frames, rec.prims);
+
+	for (l = 0; l < loops; l++) {
+		t_frame = grec_time_ms();
+		for (i = 0; i < rec.rec_count; i++) {
+			grec_play(&plugin, &rec.recs[i]);
+			if (rec.recs[i].type != GREC_VSYNC)
+				continue;
+
+			t = grec_time_ms();
+			t_frame = t - t_frame;
+			t_total += t_frame;
+			if (t_frame < t_min) t_min = t_frame;
+			if (t_frame > t_max) t_max = t_frame;
+			frames++;
+			t_frame = t;
+		}
+	}
+
+	if (frames == 0) {
+		printf("no frames in recording\n");
+	}
+	else {
+		printf("%d frames in %.1f ms: avg %.3f, min %.3f, max %.3f ms/frame\n",
+			frames, t_total, t_total / frames, t_min, t_max);
+		printf("%.0f fps, %.0f primitives/s\n", frames * 1000.0 / t_total,
+			(double)rec.prims * loops * 1000.0 / t_total);
+	}
+
+	gpu_plugin_unload(&plugin);
+	grec_free(&rec);
+
+	return 0;
+}
@@ -0,0 +1,376 @@
+/*
+ * (C) notaz, 2011
+ *
+ * This work is licensed under the terms of the GNU GPLv2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <zlib.h>
+
+#include "grec.h"
+#include "../frontend/plugin_lib.h"
+
+#define PSX_RAM_SIZE 0x200000
+
+/* minimal frontend for the plugins, exported with -rdynamic */
+void *pl_fbdev_buf;
+static unsigned char fb_mem[1024 * 512 * 4];
+static int fskip_none;
+
+int pl_fbdev_open(void)
+{
+	pl_fbdev_buf = fb_mem;
+	return 0;
+}
+
+void *pl_fbdev_set_mode(int w, int h, int bpp)
+{
+	return pl_fbdev_buf;
+}
+
+void *pl_fbdev_flip(void)
+{
+	return pl_fbdev_buf;
+}
+
+void pl_fbdev_close(void)
+{
+}
+
+static void pl_get_layer_pos(int *x, int *y, int *w, int *h)
+{
+	*x = *y = 0;
+	*w = 640; *h = 480;
+}
+
+const struct rearmed_cbs pl_rearmed_cbs = {
+	pl_get_layer_pos,
+	pl_fbdev_open,
+	pl_fbdev_set_mode,
+	pl_fbdev_flip,
+	pl_fbdev_close,
+	&fskip_none,
+};
+
+/* GP0 command parser, only used to count drawing primitives.
+ * Lengths are packet size - 1, polylines up to the first vertex pair */
+static const unsigned char cmd_lengths[256] =
+{
+	0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	3, 3, 3, 3, 6, 6, 6, 6, 4, 4, 4, 4, 8, 8, 8, 8, // 20
+	5, 5, 5, 5, 8, 8, 8, 8, 7, 7, 7, 7, 11, 11, 11, 11,
+	2, 2, 2, 2, 0, 0, 0, 0, 2, 2, 2, 2, 2, 2, 2, 2, // 40
+	3, 3, 3, 3, 0, 0, 0, 0, 3, 3, 3, 3, 3, 3, 3, 3,
+	2, 2, 2, 2, 3, 3, 3, 3, 1, 1, 1, 1, 2, 2, 2, 2, // 60
+	1, 1, 1, 1, 2, 2, 2, 2, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 80
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // a0
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // c0
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // e0
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+static struct {
+	int cmd;
+	int left;		// words left in current packet
+	int polyline;
+	unsigned int img_left;	// image words left
+} parse;
+
+static unsigned int count_prims(const uint32_t *data, int len)
+{
+	unsigned int prims = 0;
+	int i;
+
+	for (i = 0; i < len; i++) {
+		uint32_t w = data[i];
+
+		if (parse.img_left > 0) {
+			parse.img_left--;
+			continue;
+		}
+		if (parse.polyline) {
+			if ((w & 0xf000f000) == 0x50005000)
+				parse.polyline = 0;
+			continue;
+		}
+		if (parse.left > 0) {
+			if (--parse.left == 0) {
+				if (parse.cmd == 0xa0) {
+					uint32_t sz = data[i];
+					parse.img_left = ((sz & 0xffff) * (sz >> 16) + 1) / 2;
+				}
+				else if ((parse.cmd & 0xe8) == 0x48)
+					parse.polyline = 1;
+			}
+			continue;
+		}
+
+		parse.cmd = w >> 24;
+		parse.left = cmd_lengths[parse.cmd];
+		if (0x20 <= parse.cmd && parse.cmd < 0x80)
+			prims++;
+		else if (parse.cmd == 0x02)
+			prims++;
+	}
+
+	return prims;
+}
+
+static unsigned int count_chain_prims(const uint32_t *data, int len)
+{
+	unsigned int prims = 0;
+	int i, count;
+
+	for (i = 0; i < len; i += count) {
+		count = data[i++];
+		if (i + count > len)
+			break;
+		prims += count_prims(&data[i], count);
+	}
+
+	return prims;
+}
+
+int grec_load(struct grec *g, const char *fname)
+{
+	size_t size = 0, alloc = 1024 * 1024;
+	uint32_t *words, hdr;
+	unsigned char *mem, *tmp;
+	gzFile f;
+	int i, n, pos, nwords, max_recs;
+
+	memset(g, 0, sizeof(*g));
+	memset(&parse, 0, sizeof(parse));
+
+	f = gzopen(fname, "rb");
+	if (f == NULL) {
+		fprintf(stderr, "can't open %s\n", fname);
+		return -1;
+	}
+
+	mem = malloc(alloc);
+	while (mem != NULL) {
+		n = gzread(f, mem + size, alloc - size);
+		if (n <= 0)
+			break;
+		size += n;
+		if (size == alloc) {
+			alloc *= 2;
+			tmp = realloc(mem, alloc);
+			if (tmp == NULL)
+				free(mem);
+			mem = tmp;
+		}
+	}
+	gzclose(f);
+	if (mem == NULL) {
+		fprintf(stderr, "OOM\n");
+		return -1;
+	}
+
+	words = (uint32_t *)mem;
+	if (size < 12 || memcmp(mem, GREC_MAGIC, 8) != 0) {
+		fprintf(stderr, "%s: not a GPU recording\n", fname);
+		goto fail;
+	}
+	if (words[2] != GREC_VERSION) {
+		fprintf(stderr, "%s: unsupported version %u\n", fname, words[2]);
+		goto fail;
+	}
+
+	nwords = size / 4;
+	max_recs = nwords - 3;
+	g->recs = malloc(max_recs * sizeof(g->recs[0]));
+	if (g->recs == NULL) {
+		fprintf(stderr, "OOM\n");
+		goto fail;
+	}
+
+	for (pos = 3, i = 0; pos < nwords; i++) {
+		hdr = words[pos++];
+		g->recs[i].type = GREC_HDR_TYPE(hdr);
+		g->recs[i].len = GREC_HDR_LEN(hdr);
+		g->recs[i].data = &words[pos];
+		if (pos + g->recs[i].len > nwords) {
+			fprintf(stderr, "%s: truncated, using %d records\n", fname, i);
+			break;
+		}
+		pos += g->recs[i].len;
+
+		switch (g->recs[i].type) {
+		case GREC_DATA:
+			g->prims += count_prims(g->recs[i].data, g->recs[i].len);
+			break;
+		case GREC_DMACHAIN:
+			g->prims += count_chain_prims(g->recs[i].data, g->recs[i].len);
+			break;
+		case GREC_VSYNC:
+			g->frames++;
+			break;
+		}
+	}
+	g->rec_count = i;
+	g->mem = mem;
+
+	return 0;
+
+fail:
+	free(mem);
+	return -1;
+}
+
+void grec_free(struct grec *g)
+{
+	free(g->recs);
+	free(g->mem);
+	memset(g, 0, sizeof(*g));
+}
+
+#define LOAD_SYM(field, name, required) { \
+	*(void **)&p->field = dlsym(p->handle, name); \
+	if (required && p->field == NULL) { \
+		fprintf(stderr, "%s: missing %s\n", fname, name); \
+		goto fail; \
+	} \
+}
+
+int gpu_plugin_load(struct gpu_plugin *p, const char *fname)
+{
+	void (*set_cbs)(const struct rearmed_cbs *);
+	unsigned long disp = 0;
+
+	memset(p, 0, sizeof(*p));
+
+	p->handle = dlopen(fname, RTLD_NOW | RTLD_LOCAL);
+	if (p->handle == NULL) {
+		fprintf(stderr, "dlopen %s: %s\n", fname, dlerror());
+		return -1;
+	}
+
+	LOAD_SYM(init, "GPUinit", 1);
+	LOAD_SYM(shutdown, "GPUshutdown", 1);
+	LOAD_SYM(open, "GPUopen", 1);
+	LOAD_SYM(close, "GPUclose", 1);
+	LOAD_SYM(writeStatus, "GPUwriteStatus", 1);
+	LOAD_SYM(writeDataMem, "GPUwriteDataMem", 1);
+	LOAD_SYM(readDataMem, "GPUreadDataMem", 1);
+	LOAD_SYM(dmaChain, "GPUdmaChain", 1);
+	LOAD_SYM(updateLace, "GPUupdateLace", 1);
+	LOAD_SYM(freeze, "GPUfreeze", 1);
+	LOAD_SYM(vBlank, "GPUvBlank", 0);
+
+	*(void **)&set_cbs = dlsym(p->handle, "GPUrearmedCallbacks");
+	if (set_cbs != NULL)
+		set_cbs(&pl_rearmed_cbs);
+
+	p->ram = calloc(1, PSX_RAM_SIZE);
+	p->scratch = malloc(1024 * 512 * 2);
+	if (p->ram == NULL || p->scratch == NULL) {
+		fprintf(stderr, "OOM\n");
+		goto fail;
+	}
+
+	if (p->init() != 0) {
+		fprintf(stderr, "%s: GPUinit failed\n", fname);
+		goto fail;
+	}
+	if (p->open(&disp, "gpu_replay", NULL) != 0) {
+		fprintf(stderr, "%s: GPUopen failed\n", fname);
+		p->shutdown();
+		goto fail;
+	}
+
+	return 0;
+
+fail:
+	free(p->ram);
+	free(p->scratch);
+	dlclose(p->handle);
+	memset(p, 0, sizeof(*p));
+	return -1;
+}
+
+void gpu_plugin_unload(struct gpu_plugin *p)
+{
+	if (p->handle == NULL)
+		return;
+
+	p->close();
+	p->shutdown();
+	dlclose(p->handle);
+	free(p->ram);
+	free(p->scratch);
+	memset(p, 0, sizeof(*p));
+}
+
+/* lay flattened chain out as a linked list in fake RAM */
+static void play_dmachain(struct gpu_plugin *p, const uint32_t *data, int len)
+{
+	uint32_t *ram = p->ram;
+	uint32_t addr = 0, prev = 0xffffffff;
+	int i, count;
+
+	for (i = 0; i < len; i += count) {
+		count = data[i++];
+		if (i + count > len)
+			break;
+		if ((addr >> 2) + 1 + count >= PSX_RAM_SIZE / 4) {
+			// doesn't fit, send what we have so far
+			ram[prev >> 2] |= 0xffffff;
+			p->dmaChain(ram, 0);
+			addr = 0;
+			prev = 0xffffffff;
+		}
+		if (prev != 0xffffffff)
+			ram[prev >> 2] |= addr;
+		ram[addr >> 2] = count << 24;
+		memcpy(&ram[(addr >> 2) + 1], &data[i], count * 4);
+		prev = addr;
+		addr += (count + 1) * 4;
+	}
+
+	if (prev != 0xffffffff) {
+		ram[prev >> 2] |= 0xffffff;
+		p->dmaChain(ram, 0);
+	}
+}
+
+void grec_play(struct gpu_plugin *p, const struct grec_record *r)
+{
+	switch (r->type) {
+	case GREC_STATE:
+		if (r->len * 4 == sizeof(struct grec_freeze))
+			p->freeze(0, (struct grec_freeze *)r->data);
+		break;
+	case GREC_DATA:
+		p->writeDataMem(r->data, r->len);
+		break;
+	case GREC_STATUS:
+		if (r->len > 0)
+			p->writeStatus(r->data[0]);
+		break;
+	case GREC_DMACHAIN:
+		play_dmachain(p, r->data, r->len);
+		break;
+	case GREC_READ:
+		if (r->len > 0 && r->data[0] <= 1024 * 512 / 2)
+			p->readDataMem(p->scratch, r->data[0]);
+		break;
+	case GREC_VSYNC:
+		p->updateLace();
+		break;
+	case GREC_VBLANK:
+		if (r->len > 0 && p->vBlank != NULL)
+			p->vBlank(r->data[0]);
+		break;
+	}
+}
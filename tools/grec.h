@@ -0,0 +1,72 @@
+/*
+ * (C) notaz, 2011
+ *
+ * This work is licensed under the terms of the GNU GPLv2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+/* shared bits of GPU recording replay tools */
+
+#ifndef __GREC_H__
+#define __GREC_H__
+
+#include <stdint.h>
+#include <time.h>
+#include "../frontend/gpu_rec.h"
+
+struct grec_record {
+	int type;
+	int len;
+	uint32_t *data;
+};
+
+struct grec {
+	struct grec_record *recs;
+	int rec_count;
+	int frames;		// vsync records
+	unsigned int prims;	// drawing primitives in whole stream
+	void *mem;
+};
+
+/* same layout as GPUFreeze_t */
+struct grec_freeze {
+	uint32_t version;
+	uint32_t status;
+	uint32_t control[256];
+	unsigned char vram[1024 * 512 * 2];
+};
+
+struct gpu_plugin {
+	void *handle;
+	long (*init)(void);
+	long (*shutdown)(void);
+	long (*open)(unsigned long *, char *, char *);
+	long (*close)(void);
+	void (*writeStatus)(uint32_t);
+	void (*writeDataMem)(uint32_t *, int);
+	void (*readDataMem)(uint32_t *, int);
+	long (*dmaChain)(uint32_t *, uint32_t);
+	void (*updateLace)(void);
+	long (*freeze)(uint32_t, struct grec_freeze *);
+	void (*vBlank)(int);
+	uint32_t *ram;		// fake PSX RAM for rebuilding dma chains
+	uint32_t *scratch;	// GPUreadDataMem target
+};
+
+int  grec_load(struct grec *g, const char *fname);
+void grec_free(struct grec *g);
+
+int  gpu_plugin_load(struct gpu_plugin *p, const char *fname);
+void gpu_plugin_unload(struct gpu_plugin *p);
+
+/* feed one record to the plugin */
+void grec_play(struct gpu_plugin *p, const struct grec_record *r);
+
+static inline double grec_time_ms(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+#endif /* __GREC_H__ */